@@ -3,47 +3,103 @@
 #include <string>
 #include <algorithm>
 #include <limits>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <cstdio>
+#include <csignal>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ContactIO.h"
 
-struct Contact {
-    std::string name;
-    std::string phone;
-    std::string email;
-};
-
+// Names need not be unique. Search, update and remove by name act on every
+// contact with that name. Opened on a file, the book keeps every change there
+// (see ContactBook.h); otherwise it lives in memory only.
 class AddressBook {
 private:
-    std::vector<Contact> contacts;
+    static const size_t kMaxResults = 10; // Matches shown by prefix and fuzzy search
+    static const int kMaxEdits = 2;       // Typos tolerated per word by fuzzy search
+    static const size_t kOutputBlock = 1 << 20;
+
+    ContactBook contacts;
 
-    void displayContact(const Contact& contact) const {
-        std::cout << "Name: " << contact.name << "\n"
-                  << "Phone: " << contact.phone << "\n"
-                  << "Email: " << contact.email << "\n"
-                  << "---------------------------\n";
+    void reportUnsaved() const {
+        if (!contacts.saved()) {
+            std::cout << "Warning: changes could not be saved to the book file.\n";
+        }
+    }
+
+    void displayAll(const std::vector<ContactId>& found) const {
+        if (found.empty()) {
+            std::cout << "Contact not found.\n";
+            return;
+        }
+        std::string out;
+        for (ContactId id : found) {
+            formatContact(out, contacts.get(id));
+        }
+        std::cout << out;
     }
 
 public:
+    bool open(const std::string& path) {
+        return contacts.open(path);
+    }
+
+    static void formatContact(std::string& out, const ContactView& contact) {
+        out.append("Name: ").append(contact.name)
+           .append("\nPhone: ").append(contact.phone)
+           .append("\nEmail: ").append(contact.email)
+           .append("\n---------------------------\n");
+    }
+
+    // Formats straight from the field arenas into one buffer and writes it out
+    // a megabyte at a time, instead of a stream insertion per field
     void listAllContacts() const {
         if (contacts.empty()) {
             std::cout << "Address book is empty.\n";
             return;
         }
-        for (const auto& contact : contacts) {
-            displayContact(contact);
-        }
+        std::string out;
+        out.reserve(kOutputBlock + 1024);
+        contacts.forEach([&out](ContactId, const ContactView& contact) {
+            formatContact(out, contact);
+            if (out.size() >= kOutputBlock) {
+                std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+                out.clear();
+            }
+        });
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
     }
 
     void addContact(const std::string& name, const std::string& phone, const std::string& email) {
-        contacts.push_back({name, phone, email});
+        contacts.add({name, phone, email});
         std::cout << "Contact added successfully.\n";
+        reportUnsaved();
+    }
+
+    // Batch forms of addContact and removeContact for callers adding or
+    // removing many contacts at once: nothing is printed, and the journal
+    // takes one write per batch
+    void addContacts(const ContactBatch& batch) {
+        contacts.addContacts(batch);
+    }
+
+    size_t removeContacts(const std::vector<std::string>& names) {
+        return contacts.removeContacts(names);
+    }
+
+    bool saved() const {
+        return contacts.saved();
     }
 
     void removeContact(const std::string& name) {
-        auto it = std::remove_if(contacts.begin(), contacts.end(), [&name](const Contact& contact) {
-            return contact.name == name;
-        });
-        if (it != contacts.end()) {
-            contacts.erase(it, contacts.end());
+        if (contacts.removeByName(name) > 0) {
             std::cout << "Contact removed successfully.\n";
+            reportUnsaved();
         } else {
             std::cout << "Contact not found.\n";
         }
@@ -52,39 +108,470 @@ public:
     void removeAllContacts() {
         contacts.clear();
         std::cout << "All contacts removed successfully.\n";
+        reportUnsaved();
     }
 
     void searchContact(const std::string& name) const {
-        auto it = std::find_if(contacts.begin(), contacts.end(), [&name](const Contact& contact) {
-            return contact.name == name;
-        });
-        if (it != contacts.end()) {
-            displayContact(*it);
-        } else {
-            std::cout << "Contact not found.\n";
-        }
+        displayAll(contacts.findByName(name));
+    }
+
+    void searchByPhone(const std::string& phone) const {
+        displayAll(contacts.findByPhone(phone));
+    }
+
+    void searchByEmail(const std::string& email) const {
+        displayAll(contacts.findByEmail(email));
+    }
+
+    void searchByPrefix(const std::string& prefix) const {
+        displayAll(contacts.findByPrefix(prefix, kMaxResults));
+    }
+
+    void searchFuzzy(const std::string& query) const {
+        displayAll(contacts.findFuzzy(query, kMaxEdits, kMaxResults));
     }
 
     void updateContact(const std::string& name, const std::string& newPhone, const std::string& newEmail) {
-        auto it = std::find_if(contacts.begin(), contacts.end(), [&name](const Contact& contact) {
-            return contact.name == name;
-        });
-        if (it != contacts.end()) {
-            it->phone = newPhone;
-            it->email = newEmail;
+        if (contacts.updateByName(name, newPhone, newEmail) > 0) {
             std::cout << "Contact updated successfully.\n";
+            reportUnsaved();
         } else {
             std::cout << "Contact not found.\n";
         }
     }
 
-    void closeBook() const {
+    // Adds the contacts in a .csv or .jsonl file in one batch, with a single
+    // line of output however many there are
+    void importContacts(const std::string& path) {
+        ContactFormat format;
+        ImportResult result;
+        if (!contactFormatOf(path, format)) {
+            std::cout << "Unknown file type; use .csv or .jsonl.\n";
+        } else if (!importContactFile(contacts, path, format, result)) {
+            std::cout << "Could not read " << path << ".\n";
+        } else {
+            std::cout << "Imported " << result.imported << " contacts";
+            if (result.skipped > 0) std::cout << ", skipped " << result.skipped << " malformed records";
+            std::cout << ".\n";
+            reportUnsaved();
+        }
+    }
+
+    void exportContacts(const std::string& path) const {
+        ContactFormat format;
+        if (!contactFormatOf(path, format)) {
+            std::cout << "Unknown file type; use .csv or .jsonl.\n";
+        } else if (!exportContactFile(contacts, path, format)) {
+            std::cout << "Could not write " << path << ".\n";
+        } else {
+            std::cout << "Exported " << contacts.size() << " contacts.\n";
+        }
+    }
+
+    void closeBook() {
+        contacts.close();
+        reportUnsaved();
         std::cout << "Address book closed.\n";
     }
 };
 
-int main() {
+// The vector-and-scan storage AddressBook used before, kept as the benchmark baseline
+class LinearContacts {
+public:
+    void add(const Contact& contact) { contacts.push_back(contact); }
+
+    const Contact* find(const std::string& name) const {
+        auto it = std::find_if(contacts.begin(), contacts.end(), [&name](const Contact& contact) {
+            return contact.name == name;
+        });
+        return it != contacts.end() ? &*it : nullptr;
+    }
+
+    void remove(const std::string& name) {
+        contacts.erase(std::remove_if(contacts.begin(), contacts.end(), [&name](const Contact& contact) {
+            return contact.name == name;
+        }), contacts.end());
+    }
+
+private:
+    std::vector<Contact> contacts;
+};
+
+// Pseudo-random "First Last" names built from syllables: about a thousand
+// first names and thirty thousand last names, like a real directory
+std::string syntheticName(size_t i) {
+    static const char* const syllables[] = {"an", "be", "ca", "da", "el", "fa", "gi", "ha", "ir", "jo", "ka", "li",
+                                            "ma", "no", "ol", "pe", "qu", "ra", "sa", "ta", "ul", "va", "wi", "xe",
+                                            "ya", "zo", "mi", "ro", "su", "te", "ni", "lo"};
+    uint64_t h = (i + 1) * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 29;
+    std::string name;
+    for (int part = 0; part < 5; ++part) {
+        if (part == 2) name += ' ';
+        name += syllables[h & 31];
+        h >>= 5;
+    }
+    name[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+    name[5] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[5])));
+    return name;
+}
+
+Contact syntheticContact(size_t i) {
+    std::string n = std::to_string(i);
+    return {syntheticName(i), "+20 100 " + n, "user" + n + "@example.com"};
+}
+
+// Resident set size of this process, from /proc
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Memory and full-scan time of count contacts as std::strings and as columns
+void benchmarkStorage(size_t count) {
+    using Clock = std::chrono::steady_clock;
+    auto msSince = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    // Format every contact as listAllContacts does, without the output
+    size_t scanned = 0;
+    auto scan = [&scanned](std::string& out, const ContactView& contact) {
+        AddressBook::formatContact(out, contact);
+        if (out.size() >= (1 << 20)) {
+            scanned += out.size();
+            out.clear();
+        }
+    };
+
+    // Columns first, so the strings' freed heap does not flatter them
+    size_t before = residentBytes();
+    StringColumn names, phones, emails;
+    for (size_t i = 0; i < count; ++i) {
+        Contact contact = syntheticContact(i);
+        names.push(contact.name);
+        phones.push(contact.phone);
+        emails.push(contact.email);
+    }
+    size_t columnBytes = residentBytes() - before;
+
+    before = residentBytes();
+    std::vector<Contact> strings;
+    for (size_t i = 0; i < count; ++i) strings.push_back(syntheticContact(i));
+    size_t stringBytes = residentBytes() - before;
+
+    // One field of every contact, as a search over emails would
+    size_t dotCom = 0;
+    auto start = Clock::now();
+    for (const Contact& contact : strings) dotCom += contact.email.back() == 'm';
+    double stringField = msSince(start);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) dotCom += emails.get(i).back() == 'm';
+    double columnField = msSince(start);
+
+    std::string out;
+    start = Clock::now();
+    for (const Contact& contact : strings) scan(out, {contact.name, contact.phone, contact.email});
+    double stringScan = msSince(start);
+    out.clear();
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) scan(out, {names.get(i), phones.get(i), emails.get(i)});
+    double columnScan = msSince(start);
+
+    std::cout << count << " contacts (" << scanned << " bytes listed, " << dotCom << " emails read)\n"
+              << "           std::string   columns\n"
+              << "resident MB  " << stringBytes / 1e6 << "   " << columnBytes / 1e6 << "\n"
+              << "email ms     " << stringField << "   " << columnField << "\n"
+              << "list ms      " << stringScan << "   " << columnScan << "\n\n";
+}
+
+// Time lookups and removals on count contacts for both storages
+void runBenchmark(size_t count) {
+    using Clock = std::chrono::steady_clock;
+    auto nsPerOp = [](Clock::time_point start, size_t ops) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(ops);
+    };
+    benchmarkStorage(count);
+    const size_t linearOps = 200;
+    const size_t indexedOps = 1000000;
+
+    LinearContacts linear;
+    ContactStore indexed;
+    indexed.reserve(count);
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i) linear.add(syntheticContact(i));
+    double linearAdd = nsPerOp(start, count);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        Contact contact = syntheticContact(i);
+        indexed.add({contact.name, contact.phone, contact.email});
+    }
+    double indexedAdd = nsPerOp(start, count);
+
+    size_t hits = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < linearOps; ++i) hits += linear.find(syntheticContact(i * 7919 % count).name) != nullptr;
+    double linearFind = nsPerOp(start, linearOps);
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 4096; ++i) names.push_back(syntheticContact(i * 7919 % count).name);
+    start = Clock::now();
+    for (size_t i = 0; i < indexedOps; ++i) hits += indexed.findByName(names[i % names.size()]).size();
+    double indexedFind = nsPerOp(start, indexedOps);
+
+    start = Clock::now();
+    for (size_t i = 0; i < linearOps; ++i) linear.remove(syntheticContact(i).name);
+    double linearRemove = nsPerOp(start, linearOps);
+    size_t removals = std::min(count / 2, indexedOps); // Leave half for the searches below
+    start = Clock::now();
+    for (size_t i = 0; i < removals; ++i) {
+        for (ContactId id : indexed.findByName(syntheticContact(i).name)) indexed.remove(id);
+    }
+    double indexedRemove = nsPerOp(start, removals);
+
+    // Queries typed against what is left: a prefix, and a name with a typo
+    std::vector<std::string> prefixes, typos;
+    for (size_t i = 0; i < 1000; ++i) {
+        std::string name = syntheticName(count - 1 - i * 7 % (count / 2));
+        prefixes.push_back(name.substr(0, 3 + i % 5));
+        name[name.size() - 2] = 'q';
+        typos.push_back(name);
+    }
+    start = Clock::now();
+    for (const auto& prefix : prefixes) hits += indexed.findByPrefix(prefix, 10).size();
+    double prefixFind = nsPerOp(start, prefixes.size());
+    start = Clock::now();
+    for (const auto& typo : typos) hits += indexed.findFuzzy(typo, 2, 10).size();
+    double fuzzyFind = nsPerOp(start, typos.size());
+
+    std::cout << count << " contacts (" << hits << " hits)\n"
+              << "           linear ns/op   indexed ns/op\n"
+              << "add      " << linearAdd << "   " << indexedAdd << "\n"
+              << "search   " << linearFind << "   " << indexedFind << "\n"
+              << "remove   " << linearRemove << "   " << indexedRemove << "\n"
+              << "prefix top-10   " << prefixFind << " ns\n"
+              << "fuzzy top-10    " << fuzzyFind << " ns\n";
+}
+
+void removeBookFiles(const std::string& path) {
+    for (const char* suffix : {"", ".tmp", ".journal", ".journal.tmp"}) {
+        std::remove((path + suffix).c_str());
+    }
+}
+
+// Time writing a book file of count contacts, opening it and a first few
+// operations on it
+void benchmarkBookFile(const std::string& path, size_t count) {
+    using Clock = std::chrono::steady_clock;
+    auto usSince = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    };
+    removeBookFiles(path);
+    auto start = Clock::now();
+    bool written = writeBook(path, 1, Journal::start(), [count](auto visit) {
+        for (size_t i = 0; i < count; ++i) {
+            Contact contact = syntheticContact(i);
+            visit(ContactView{contact.name, contact.phone, contact.email});
+        }
+    }) && Journal::create(path + ".journal", 1, "");
+    double writeUs = usSince(start);
+
+    ContactBook book;
+    start = Clock::now();
+    if (!written || !book.open(path)) {
+        std::cout << "Could not write " << path << "\n";
+        return;
+    }
+    double openUs = usSince(start);
+    std::string name = syntheticName(count / 2);
+    start = Clock::now();
+    size_t hits = book.findByName(name).size();
+    double findUs = usSince(start);
+    start = Clock::now();
+    hits += book.findByPrefix(name.substr(0, 4), 10).size();
+    double prefixUs = usSince(start);
+    start = Clock::now();
+    book.add({"Added Contact", "+20 100 0", "added@example.com"});
+    double addUs = usSince(start);
+
+    struct stat st;
+    ::stat(path.c_str(), &st);
+    std::cout << count << " contacts, " << st.st_size / 1e6 << " MB (" << hits << " hits)\n"
+              << "write     " << writeUs / 1000 << " ms\n"
+              << "open      " << openUs << " us\n"
+              << "find      " << findUs << " us\n"
+              << "prefix    " << prefixUs << " us\n"
+              << "add       " << addUs << " us\n";
+}
+
+// Time a bulk round trip of count contacts: batch add in memory, export to
+// CSV and JSON lines, import the CSV into a book file at path and the JSON
+// lines into memory, and a batch removal
+void benchmarkImport(const std::string& path, size_t count) {
+    using Clock = std::chrono::steady_clock;
+    auto msSince = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    std::string csv = path + ".csv", jsonl = path + ".jsonl";
+    removeBookFiles(path);
+    double addMs, csvOutMs, jsonOutMs;
+    {
+        ContactBatch batch;
+        for (size_t i = 0; i < count; ++i) {
+            Contact contact = syntheticContact(i);
+            batch.add({contact.name, contact.phone, contact.email});
+        }
+        ContactBook book;
+        auto start = Clock::now();
+        book.addContacts(batch);
+        addMs = msSince(start);
+        start = Clock::now();
+        bool written = exportContactFile(book, csv, ContactFormat::kCsv);
+        csvOutMs = msSince(start);
+        start = Clock::now();
+        written = written && exportContactFile(book, jsonl, ContactFormat::kJsonLines);
+        jsonOutMs = msSince(start);
+        if (!written) {
+            std::cout << "Could not write " << csv << " or " << jsonl << "\n";
+            return;
+        }
+    }
+
+    ImportResult fromCsv, fromJson;
+    double csvInMs, jsonInMs, removeMs;
+    size_t removed;
+    {
+        ContactBook book;
+        auto start = Clock::now();
+        if (!book.open(path) || !importContactFile(book, csv, ContactFormat::kCsv, fromCsv)) {
+            std::cout << "Could not import " << csv << " into " << path << "\n";
+            return;
+        }
+        book.close(); // Synced, as an import must be before it counts
+        csvInMs = msSince(start);
+
+        book.open(path);
+        std::vector<std::string> names;
+        for (size_t i = 0; i < 100000 && i < count; ++i) names.push_back(syntheticName(i * 7919 % count));
+        start = Clock::now();
+        removed = book.removeContacts(names);
+        removeMs = msSince(start);
+    }
+    {
+        ContactBook book;
+        auto start = Clock::now();
+        importContactFile(book, jsonl, ContactFormat::kJsonLines, fromJson);
+        jsonInMs = msSince(start);
+        bool same = book.size() == count;
+        for (size_t i = 0; same && i < count; i += std::max<size_t>(1, count / 1000)) {
+            Contact contact = syntheticContact(i);
+            same = book.findByPhone(contact.phone).size() == 1 &&
+                   book.get(book.findByPhone(contact.phone)[0]).email == contact.email;
+        }
+        if (!same || fromCsv.imported != count || fromCsv.skipped + fromJson.skipped != 0) {
+            std::cout << "Round trip lost contacts: " << fromCsv.imported << " and " << fromJson.imported << " of "
+                      << count << "\n";
+        }
+    }
+
+    struct stat st;
+    ::stat(csv.c_str(), &st);
+    std::cout << count << " contacts, CSV " << st.st_size / 1e6 << " MB\n"
+              << "batch add in memory   " << addMs << " ms\n"
+              << "export CSV            " << csvOutMs << " ms\n"
+              << "export JSON lines     " << jsonOutMs << " ms\n"
+              << "import CSV to file    " << csvInMs << " ms\n"
+              << "import JSON lines     " << jsonInMs << " ms\n"
+              << "batch remove " << removed << "   " << removeMs << " ms\n";
+}
+
+// Adds contacts in a child process and kills it at random moments, then
+// checks that the book reopens holding exactly the first k contacts the
+// child added, for a k that never goes down. The small compaction threshold
+// puts some of the kills inside a snapshot switch.
+int runCrashTest(const std::string& path, int rounds) {
+    const size_t compactBytes = 256 << 10;
+    removeBookFiles(path);
+    std::mt19937 random(12345);
+    size_t survived = 0;
+    for (int round = 0; round < rounds; ++round) {
+        int ready[2];
+        pid_t child = pipe(ready) == 0 ? fork() : -1;
+        if (child < 0) {
+            std::perror("fork");
+            return 1;
+        }
+        if (child == 0) {
+            ContactBook book;
+            if (!book.open(path, compactBytes)) _exit(2);
+            char byte = 1;
+            if (write(ready[1], &byte, 1) != 1) _exit(2);
+            for (size_t i = book.size();; ++i) {
+                Contact contact = syntheticContact(i);
+                book.add({contact.name, contact.phone, contact.email});
+            }
+        }
+        // Kill the writer at a random moment once it has opened the book
+        char byte;
+        ssize_t opened = read(ready[0], &byte, 1);
+        close(ready[0]);
+        close(ready[1]);
+        if (opened == 1) usleep(random() % 30000);
+        kill(child, SIGKILL);
+        int status;
+        waitpid(child, &status, 0);
+        if (WIFEXITED(status)) {
+            std::cout << "round " << round << ": the writer could not open the book\n";
+            return 1;
+        }
+
+        ContactBook book;
+        if (!book.open(path, compactBytes)) {
+            std::cout << "round " << round << ": the book does not open\n";
+            return 1;
+        }
+        size_t count = 0;
+        bool intact = true;
+        book.forEach([&](ContactId, const ContactView& contact) {
+            Contact expected = syntheticContact(count++);
+            intact = intact && contact.name == expected.name && contact.phone == expected.phone &&
+                     contact.email == expected.email;
+        });
+        if (intact && count > 0) intact = book.findByPhone(syntheticContact(count - 1).phone).size() == 1;
+        if (!intact || count < survived) {
+            std::cout << "round " << round << ": " << count << " contacts, expected the first " << survived
+                      << " or more, in order\n";
+            return 1;
+        }
+        std::cout << "round " << round << ": " << count << " contacts intact\n";
+        survived = count;
+    }
+    std::cout << "Crash test passed.\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmark(argc > 2 ? std::stoul(argv[2]) : 1000000);
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--bench-file") {
+        benchmarkBookFile(argv[2], argc > 3 ? std::stoul(argv[3]) : 1000000);
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--bench-import") {
+        benchmarkImport(argv[2], argc > 3 ? std::stoul(argv[3]) : 1000000);
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--crash-test") {
+        return runCrashTest(argv[2], argc > 3 ? std::stoi(argv[3]) : 20);
+    }
+
     AddressBook book;
+    if (argc > 1 && !book.open(argv[1])) {
+        std::cout << "Could not open address book " << argv[1] << "\n";
+        return 1;
+    }
     int choice;
     std::string name, phone, email;
 
@@ -97,9 +584,15 @@ int main() {
                   << "5. Search for a contact\n"
                   << "6. Update a contact\n"
                   << "7. Close the address book\n"
+                  << "8. Search by phone\n"
+                  << "9. Search by email\n"
+                  << "10. Search by name prefix\n"
+                  << "11. Fuzzy search by name\n"
+                  << "12. Import contacts from a file\n"
+                  << "13. Export contacts to a file\n"
                   << "Enter your choice: ";
-        std::cin >> choice;
-        std::cin.ignore('\n'); // Clear input buffer
+        if (!(std::cin >> choice)) break;
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear input buffer
 
         switch (choice) {
             case 1:
@@ -139,6 +632,36 @@ int main() {
             case 7:
                 book.closeBook();
                 break;
+            case 8:
+                std::cout << "Enter phone of the contact to search: ";
+                std::getline(std::cin, phone);
+                book.searchByPhone(phone);
+                break;
+            case 9:
+                std::cout << "Enter email of the contact to search: ";
+                std::getline(std::cin, email);
+                book.searchByEmail(email);
+                break;
+            case 10:
+                std::cout << "Enter the start of the name: ";
+                std::getline(std::cin, name);
+                book.searchByPrefix(name);
+                break;
+            case 11:
+                std::cout << "Enter the name, typos allowed: ";
+                std::getline(std::cin, name);
+                book.searchFuzzy(name);
+                break;
+            case 12:
+                std::cout << "Enter the file to import (.csv or .jsonl): ";
+                std::getline(std::cin, name);
+                book.importContacts(name);
+                break;
+            case 13:
+                std::cout << "Enter the file to export to (.csv or .jsonl): ";
+                std::getline(std::cin, name);
+                book.exportContacts(name);
+                break;
             default:
                 std::cout << "Invalid choice. Please try again.\n";
                 break;
@@ -0,0 +1,288 @@
+#ifndef BOOK_FILE_H
+#define BOOK_FILE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ContactStore.h"
+
+// Snapshot of an address book on disk, queried in place through mmap.
+//
+// Layout: a BookHeader, then sections at 8-byte aligned offsets: for each
+// field the StringColumn references and arena, for each field the FlatIndex
+// slots and chains, and the PrefixIndex entries in name order. Contacts are
+// numbered 0..count-1 in the order they were written. Opening maps the file
+// and checks the header, nothing more, so it takes the same time whatever the
+// size of the book. The file is trusted beyond that: it is only ever written
+// whole by writeBook(), synced, and renamed into place.
+
+const char kBookMagic[8] = {'A', 'B', 'O', 'O', 'K', '0', '0', '1'};
+
+enum BookField { kNameField, kPhoneField, kEmailField, kFieldCount };
+
+enum BookSection {
+    kRefsSection = 0,                      // Per field
+    kArenaSection = kFieldCount,           // Per field
+    kSlotsSection = 2 * kFieldCount,       // Per field
+    kChainsSection = 3 * kFieldCount,      // Per field
+    kPrefixSection = 4 * kFieldCount,
+    kSectionCount
+};
+
+struct BookHeader {
+    char magic[8];
+    uint64_t generation;    // Of the journal that applies on top, see ContactBook.h
+    uint64_t journalOffset; // Where the previous generation's journal goes on from this snapshot
+    uint64_t count;
+    uint64_t fileSize;
+    struct {
+        uint64_t offset;
+        uint64_t size;
+    } sections[kSectionCount];
+};
+
+namespace bookfile {
+
+inline bool writeAll(int fd, const void* data, size_t size, uint64_t offset) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// Makes a rename or a new file in dir durable
+inline void syncDirectory(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return;
+    ::fsync(fd);
+    ::close(fd);
+}
+
+// Calls job(0) .. job(count - 1), on as many threads as there are cores
+template <typename Job>
+void parallelFor(size_t count, Job job) {
+    size_t threads = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) job(i);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t i = t; i < count; i += threads) job(i);
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+}
+
+} // namespace bookfile
+
+// Writes the contacts forEachContact(visit) passes to visit(ContactView) as a
+// snapshot to fd, from offset 0, and syncs it. Builds the whole snapshot in
+// memory first.
+template <typename ForEachContact>
+bool writeBook(int fd, uint64_t generation, uint64_t journalOffset, ForEachContact forEachContact) {
+    StringColumn columns[kFieldCount];
+    bool fits = true;
+    forEachContact([&](const ContactView& contact) {
+        fits &= columns[kNameField].push(contact.name);
+        fits &= columns[kPhoneField].push(contact.phone);
+        fits &= columns[kEmailField].push(contact.email);
+    });
+    if (!fits) return false; // A field outgrew the 4 GiB its arena offsets reach
+    uint32_t count = static_cast<uint32_t>(columns[kNameField].size());
+
+    // The three hash indexes and the name order are independent of each other
+    FlatIndex indexes[kFieldCount];
+    std::vector<PrefixIndex::Entry> prefix;
+    bookfile::parallelFor(kFieldCount + 1, [&](size_t job) {
+        if (job < kFieldCount) {
+            const StringColumn& column = columns[job];
+            indexes[job].build(count, [&](uint32_t id) { return indexHash(column.get(id)); },
+                               [&](uint32_t a, uint32_t b) { return column.get(a) == column.get(b); });
+            return;
+        }
+        auto nameOf = [&](uint32_t id) { return columns[kNameField].get(id); };
+        prefix.reserve(count);
+        for (uint32_t id = 0; id < count; ++id) prefix.push_back(PrefixIndex::entryOf(id, nameOf(id)));
+        PrefixIndex::sortEntries(prefix, nameOf);
+    });
+
+    const void* data[kSectionCount];
+    BookHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kBookMagic, sizeof(header.magic));
+    header.generation = generation;
+    header.journalOffset = journalOffset;
+    header.count = count;
+    for (int field = 0; field < kFieldCount; ++field) {
+        data[kRefsSection + field] = columns[field].refs();
+        header.sections[kRefsSection + field].size = count * sizeof(StringColumn::Ref);
+        data[kArenaSection + field] = columns[field].arena();
+        header.sections[kArenaSection + field].size = columns[field].arenaSize();
+        data[kSlotsSection + field] = indexes[field].slots().data();
+        header.sections[kSlotsSection + field].size = indexes[field].slots().size() * sizeof(FlatIndex::Slot);
+        data[kChainsSection + field] = indexes[field].chains().data();
+        header.sections[kChainsSection + field].size = count * sizeof(uint32_t);
+    }
+    data[kPrefixSection] = prefix.data();
+    header.sections[kPrefixSection].size = count * sizeof(PrefixIndex::Entry);
+
+    uint64_t offset = sizeof(header);
+    for (auto& section : header.sections) {
+        offset = (offset + 7) & ~uint64_t(7);
+        section.offset = offset;
+        offset += section.size;
+    }
+    header.fileSize = offset;
+
+    bool ok = ::ftruncate(fd, static_cast<off_t>(header.fileSize)) == 0 &&
+              bookfile::writeAll(fd, &header, sizeof(header), 0);
+    for (int s = 0; s < kSectionCount && ok; ++s) {
+        ok = bookfile::writeAll(fd, data[s], header.sections[s].size, header.sections[s].offset);
+    }
+    return ok && ::fsync(fd) == 0;
+}
+
+// Same, as a new file at path
+template <typename ForEachContact>
+bool writeBook(const std::string& path, uint64_t generation, uint64_t journalOffset, ForEachContact forEachContact) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    bool ok = writeBook(fd, generation, journalOffset, forEachContact);
+    ::close(fd);
+    return ok;
+}
+
+// A snapshot mapped read-only; ids are 0..size()-1
+class MappedBook {
+public:
+    MappedBook() : data_(nullptr), size_(0), header_(nullptr) {}
+    ~MappedBook() { close(); }
+
+    MappedBook(const MappedBook&) = delete;
+    MappedBook& operator=(const MappedBook&) = delete;
+
+    // False if path is missing or not a well-formed snapshot
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        bool opened = open(fd);
+        ::close(fd);
+        return opened;
+    }
+
+    // Same for the file open at fd, which the mapping outlives
+    bool open(int fd) {
+        close();
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(BookHeader)) return false;
+        void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) return false;
+        data_ = static_cast<const char*>(data);
+        size_ = static_cast<size_t>(st.st_size);
+        header_ = reinterpret_cast<const BookHeader*>(data_);
+        if (!valid()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+        header_ = nullptr;
+    }
+
+    void swap(MappedBook& other) {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(header_, other.header_);
+    }
+
+    bool isOpen() const { return header_ != nullptr; }
+    uint32_t size() const { return header_ ? static_cast<uint32_t>(header_->count) : 0; }
+    uint64_t generation() const { return header_ ? header_->generation : 0; }
+    uint64_t journalOffset() const { return header_ ? header_->journalOffset : 0; }
+
+    std::string_view field(int field, uint32_t id) const {
+        return StringColumn::view(section<StringColumn::Ref>(kRefsSection + field)[id],
+                                  section<char>(kArenaSection + field));
+    }
+
+    ContactView get(uint32_t id) const {
+        return {field(kNameField, id), field(kPhoneField, id), field(kEmailField, id)};
+    }
+
+    // Call visit(id) for every contact whose field equals key
+    template <typename Visit>
+    void find(int field, std::string_view key, Visit visit) const {
+        if (!header_) return;
+        FlatIndex::find(section<FlatIndex::Slot>(kSlotsSection + field),
+                        header_->sections[kSlotsSection + field].size / sizeof(FlatIndex::Slot),
+                        section<uint32_t>(kChainsSection + field), indexHash(key),
+                        [&](uint32_t id) { return this->field(field, id) == key; }, visit);
+    }
+
+    // Call visit(id) for contacts whose name starts with prefix, ignoring
+    // case, in name order until visit returns false
+    template <typename Visit>
+    void scanPrefix(std::string_view prefix, Visit visit) const {
+        if (!header_) return;
+        PrefixIndex::scan(section<PrefixIndex::Entry>(kPrefixSection), size(), prefix,
+                          [this](uint32_t id) { return field(kNameField, id); }, visit);
+    }
+
+private:
+    template <typename T>
+    const T* section(int s) const {
+        return reinterpret_cast<const T*>(data_ + header_->sections[s].offset);
+    }
+
+    bool valid() const {
+        const BookHeader& h = *header_;
+        if (std::memcmp(h.magic, kBookMagic, sizeof(h.magic)) != 0 || h.fileSize != size_ ||
+            h.count > 0xffffffffu) {
+            return false;
+        }
+        for (const auto& s : h.sections) {
+            if (s.offset % 8 != 0 || s.offset > size_ || s.size > size_ - s.offset) return false;
+        }
+        for (int field = 0; field < kFieldCount; ++field) {
+            uint64_t slots = h.sections[kSlotsSection + field].size / sizeof(FlatIndex::Slot);
+            if (h.sections[kRefsSection + field].size != h.count * sizeof(StringColumn::Ref) ||
+                h.sections[kChainsSection + field].size != h.count * sizeof(uint32_t) ||
+                (slots & (slots - 1)) != 0 || (slots == 0 && h.count != 0)) {
+                return false;
+            }
+        }
+        return h.sections[kPrefixSection].size == h.count * sizeof(PrefixIndex::Entry);
+    }
+
+    const char* data_;
+    size_t size_;
+    const BookHeader* header_;
+};
+
+#endif // BOOK_FILE_H
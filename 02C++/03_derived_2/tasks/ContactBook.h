@@ -0,0 +1,450 @@
+#ifndef CONTACT_BOOK_H
+#define CONTACT_BOOK_H
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "BookFile.h"
+#include "ContactStore.h"
+#include "Journal.h"
+
+// An address book kept in a file: a mapped snapshot (BookFile.h) plus the
+// changes made since, held in memory and in a journal (Journal.h) at
+// <path>.journal. Without a file the book lives in memory only.
+//
+// Contacts of the snapshot keep its numbering, and removing one only marks
+// it. Contacts added since live in a ContactStore and are numbered after the
+// snapshot's; updating a snapshot contact moves it there. The journal records
+// operations, not ids, so it can be replayed on top of any snapshot that
+// does not yet include them.
+//
+// Once the journal outgrows compactBytes, a thread writes a new snapshot of
+// the whole book, and the next change switches over to it. The switch is
+// ordered so that a crash at any point leaves a book that opens intact:
+//   1. the thread writes snapshot generation g+1 to <path>.tmp, noting the
+//      journal size P it includes, and syncs it;
+//   2. <path>.tmp is renamed over <path>. A crash now leaves snapshot g+1
+//      with journal g, and opening replays journal g from P on;
+//   3. the journal records from P on are copied into a new journal g+1,
+//      which is synced and renamed over <path>.journal.
+//
+// A bulk add large next to the book skips the journal: the batch and the
+// book are written as a new snapshot on the spot, which is the same switch
+// with P at the end of the journal. An in-memory book keeps that snapshot in
+// an anonymous file.
+class ContactBook {
+public:
+    // Bounds the journal replayed on open: some 15,000 changes
+    static const size_t kDefaultCompactBytes = 1 << 20;
+    // Smallest batch worth a new snapshot, if also a quarter of the book
+    static const size_t kMinRebuildBatch = 4096;
+
+    ContactBook() = default;
+    ~ContactBook() { close(); }
+
+    ContactBook(const ContactBook&) = delete;
+    ContactBook& operator=(const ContactBook&) = delete;
+
+    // Opens the book at path, creating it if missing; false if it cannot be
+    // created or is not a book. The book is empty and in memory after a failure.
+    bool open(const std::string& path, size_t compactBytes = kDefaultCompactBytes) {
+        close();
+        path_ = path;
+        compactBytes_ = compactBytes;
+        bool opened = (::access(path.c_str(), F_OK) == 0 || createFiles()) && base_.open(path);
+        if (opened && !journal_.open(journalPath())) {
+            // Only a crash during createFiles() leaves a snapshot without journal
+            opened = Journal::create(journalPath(), base_.generation(), "") && journal_.open(journalPath());
+        }
+        if (opened && journal_.generation() + 1 == base_.generation()) {
+            // Killed between steps 2 and 3 of a switch: finish it
+            opened = switchJournal(base_.journalOffset(), base_.generation());
+        }
+        opened = opened && journal_.generation() == base_.generation() && load(Journal::start());
+        if (!opened) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // Finishes a compaction in progress and syncs the journal
+    void close() {
+        if (compactor_.joinable()) finishCompaction();
+        if (journal_.isOpen() && !journal_.sync()) saved_ = false;
+        journal_.close();
+        base_.close();
+        path_.clear();
+        resetChanges();
+        saved_ = true;
+    }
+
+    // False once a change could not be written to the journal; it still
+    // applies in memory
+    bool saved() const { return saved_; }
+
+    size_t size() const { return baseLive_ + added_.size(); }
+    bool empty() const { return size() == 0; }
+
+    void add(ContactView contact) {
+        log(kAddContact, {contact.name, contact.phone, contact.email});
+        applyAdd(contact);
+        maintain();
+    }
+
+    // Adds every contact in batch, as one journal write or one new snapshot
+    void addContacts(const ContactBatch& batch) {
+        if (batch.size() >= kMinRebuildBatch && batch.size() * 4 >= size() && rebuild(batch)) return;
+        std::string records;
+        for (size_t i = 0; i < batch.size() && !path_.empty(); ++i) {
+            ContactView contact = batch.get(i);
+            Journal::encode(records, kAddContact, {contact.name, contact.phone, contact.email});
+        }
+        logRecords(records);
+        for (size_t i = 0; i < batch.size(); ++i) applyAdd(batch.get(i));
+        maintain();
+    }
+
+    // Removes every contact with one of names, as one journal write; number
+    // of contacts removed
+    size_t removeContacts(const std::vector<std::string>& names) {
+        std::string records;
+        for (const std::string& name : names) {
+            if (!path_.empty() && !findByName(name).empty()) Journal::encode(records, kRemoveByName, {name});
+        }
+        logRecords(records);
+        size_t removed = 0;
+        for (const std::string& name : names) removed += applyRemove(name);
+        maintain();
+        return removed;
+    }
+
+    // Number of contacts removed
+    size_t removeByName(std::string_view name) {
+        if (findByName(name).empty()) return 0;
+        log(kRemoveByName, {name});
+        size_t removed = applyRemove(name);
+        maintain();
+        return removed;
+    }
+
+    // Number of contacts updated
+    size_t updateByName(std::string_view name, std::string_view phone, std::string_view email) {
+        if (findByName(name).empty()) return 0;
+        log(kUpdateByName, {name, phone, email});
+        size_t updated = applyUpdate(name, phone, email);
+        maintain();
+        return updated;
+    }
+
+    void clear() {
+        log(kClearBook, {});
+        applyClear();
+        maintain();
+    }
+
+    ContactView get(ContactId id) const {
+        return id < base_.size() ? base_.get(id) : added_.get(id - base_.size());
+    }
+
+    std::vector<ContactId> findByName(std::string_view name) const { return find(kNameField, name); }
+    std::vector<ContactId> findByPhone(std::string_view phone) const { return find(kPhoneField, phone); }
+    std::vector<ContactId> findByEmail(std::string_view email) const { return find(kEmailField, email); }
+
+    // Up to limit contacts whose name starts with prefix, ignoring case, by name
+    std::vector<ContactId> findByPrefix(std::string_view prefix, size_t limit) const {
+        std::vector<ContactId> ids;
+        if (limit == 0) return ids;
+        base_.scanPrefix(prefix, [&](uint32_t id) {
+            if (!removed_[id]) ids.push_back(id);
+            return ids.size() < limit;
+        });
+        size_t fromBase = ids.size();
+        for (ContactId id : added_.findByPrefix(prefix, limit)) ids.push_back(base_.size() + id);
+        std::inplace_merge(ids.begin(), ids.begin() + static_cast<std::ptrdiff_t>(fromBase), ids.end(),
+                           [this](ContactId a, ContactId b) { return compareFolded(get(a).name, get(b).name) < 0; });
+        if (ids.size() > limit) ids.resize(limit);
+        return ids;
+    }
+
+    // Up to limit contacts whose name words are each within maxDistance edits
+    // of a query word, closest first. The snapshot's fuzzy index is built on
+    // first use.
+    std::vector<ContactId> findFuzzy(std::string_view query, int maxDistance, size_t limit) const {
+        if (!baseWordsBuilt_) {
+            for (uint32_t id = 0; id < base_.size(); ++id) {
+                if (!removed_[id]) baseWords_.insert(id, base_.field(kNameField, id));
+            }
+            baseWordsBuilt_ = true;
+        }
+        auto nameOf = [this](uint32_t id) { return base_.field(kNameField, id); };
+        std::vector<std::pair<ContactId, int>> ranked = baseWords_.find(query, maxDistance, limit, nameOf);
+        size_t fromBase = ranked.size();
+        for (const auto& match : added_.findFuzzyRanked(query, maxDistance, limit)) {
+            ranked.push_back({base_.size() + match.first, match.second});
+        }
+        std::inplace_merge(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(fromBase), ranked.end(),
+                           [](const std::pair<ContactId, int>& a, const std::pair<ContactId, int>& b) {
+                               return a.second < b.second;
+                           });
+        std::vector<ContactId> ids;
+        for (size_t i = 0; i < ranked.size() && i < limit; ++i) ids.push_back(ranked[i].first);
+        return ids;
+    }
+
+    // Call visit(id, contact) for every contact, snapshot ones first
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (uint32_t id = 0; id < base_.size(); ++id) {
+            if (!removed_[id]) visit(id, base_.get(id));
+        }
+        uint32_t offset = base_.size();
+        added_.forEach([&](ContactId id, const ContactView& contact) { visit(offset + id, contact); });
+    }
+
+private:
+    std::string journalPath() const { return path_ + ".journal"; }
+
+    bool createFiles() {
+        bool ok = writeBook(path_ + ".tmp", 1, Journal::start(), [](auto) {}) &&
+                  Journal::create(journalPath(), 1, "") &&
+                  std::rename((path_ + ".tmp").c_str(), path_.c_str()) == 0;
+        bookfile::syncDirectory(path_);
+        return ok;
+    }
+
+    // Replays the journal from offset on top of the mapped snapshot
+    bool load(uint64_t offset) {
+        loadBase();
+        replaying_ = true;
+        bool ok = journal_.replay(offset, [this](JournalOp op, const std::string_view* fields,
+                                                             size_t count) {
+            if (op == kAddContact && count == 3) {
+                applyAdd({fields[0], fields[1], fields[2]});
+            } else if (op == kRemoveByName && count == 1) {
+                applyRemove(fields[0]);
+            } else if (op == kUpdateByName && count == 3) {
+                applyUpdate(fields[0], fields[1], fields[2]);
+            } else if (op == kClearBook) {
+                applyClear();
+            }
+        });
+        replaying_ = false;
+        return ok;
+    }
+
+    // The mapped snapshot alone
+    void loadBase() {
+        resetChanges();
+        removed_.assign(base_.size(), 0);
+        baseLive_ = base_.size();
+    }
+
+    void resetChanges() {
+        removed_.clear();
+        baseLive_ = 0;
+        added_.clear();
+        baseWords_.clear();
+        baseWordsBuilt_ = false;
+    }
+
+    void log(JournalOp op, std::initializer_list<std::string_view> fields) {
+        if (path_.empty() || replaying_) return;
+        if (!journal_.append(op, fields)) saved_ = false;
+    }
+
+    void logRecords(std::string_view records) {
+        if (path_.empty() || replaying_ || records.empty()) return;
+        if (!journal_.append(records)) saved_ = false;
+    }
+
+    void applyAdd(ContactView contact) { added_.add(contact); }
+
+    size_t applyRemove(std::string_view name) {
+        size_t removed = 0;
+        for (ContactId id : findByName(name)) {
+            if (id < base_.size()) {
+                removeFromBase(id);
+            } else {
+                added_.remove(id - base_.size());
+            }
+            ++removed;
+        }
+        return removed;
+    }
+
+    size_t applyUpdate(std::string_view name, std::string_view phone, std::string_view email) {
+        std::vector<ContactId> found = findByName(name);
+        std::string kept(name); // name may point into a contact about to go
+        for (ContactId id : found) {
+            if (id < base_.size()) {
+                removeFromBase(id);
+                added_.add({kept, phone, email});
+            } else {
+                added_.update(id - base_.size(), phone, email);
+            }
+        }
+        return found.size();
+    }
+
+    void applyClear() {
+        removed_.assign(base_.size(), 1);
+        baseLive_ = 0;
+        added_.clear();
+        baseWords_.clear();
+    }
+
+    void removeFromBase(uint32_t id) {
+        if (baseWordsBuilt_) baseWords_.erase(id, base_.field(kNameField, id));
+        removed_[id] = 1;
+        --baseLive_;
+    }
+
+    std::vector<ContactId> find(int field, std::string_view key) const {
+        std::vector<ContactId> ids;
+        base_.find(field, key, [&](uint32_t id) {
+            if (!removed_[id]) ids.push_back(id);
+        });
+        std::sort(ids.begin(), ids.end());
+        std::vector<ContactId> added = field == kNameField    ? added_.findByName(key)
+                                       : field == kPhoneField ? added_.findByPhone(key)
+                                                              : added_.findByEmail(key);
+        for (ContactId id : added) ids.push_back(base_.size() + id);
+        return ids;
+    }
+
+    // Starts or finishes a background compaction as due
+    void maintain() {
+        if (path_.empty() || !saved_) return;
+        if (compactor_.joinable()) {
+            if (compactDone_) finishCompaction();
+        } else if (journal_.size() - Journal::start() > compactBytes_) {
+            startCompaction();
+        }
+    }
+
+    void startCompaction() {
+        // The thread reads the snapshot, which stays mapped until it is done,
+        // and a copy of the changes so far
+        std::vector<uint8_t> removed = removed_;
+        std::vector<Contact> added;
+        added.reserve(added_.size());
+        added_.forEach([&](ContactId, const ContactView& contact) {
+            added.push_back({std::string(contact.name), std::string(contact.phone), std::string(contact.email)});
+        });
+        compactOffset_ = journal_.size();
+        compactDone_ = false;
+        uint64_t generation = base_.generation() + 1;
+        compactor_ = std::thread([this, generation, removed = std::move(removed), added = std::move(added)] {
+            compactOk_ = writeBook(path_ + ".tmp", generation, compactOffset_, [&](auto visit) {
+                for (uint32_t id = 0; id < base_.size(); ++id) {
+                    if (!removed[id]) visit(base_.get(id));
+                }
+                for (const Contact& contact : added) visit(ContactView{contact.name, contact.phone, contact.email});
+            });
+            compactDone_ = true;
+        });
+    }
+
+    void finishCompaction() {
+        compactor_.join();
+        installSnapshot(compactOk_); // If not, the next change retries
+    }
+
+    // Steps 2 and 3 for the snapshot written to <path>.tmp; false if it did
+    // not replace the old one
+    bool installSnapshot(bool written) {
+        std::string tmp = path_ + ".tmp";
+        if (!written || std::rename(tmp.c_str(), path_.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        bookfile::syncDirectory(path_);
+
+        // From here on the new snapshot is the book on disk. Should a step
+        // below fail, the files are left as after a crash at that step, and
+        // the book stops compacting.
+        MappedBook next;
+        if (!next.open(path_)) {
+            saved_ = false; // Carry on in memory with the old snapshot
+            return true;
+        }
+        base_.swap(next);
+        if (!switchJournal(base_.journalOffset(), base_.generation())) {
+            saved_ = false;
+            load(base_.journalOffset()); // Still the old journal
+            return true;
+        }
+        if (!load(Journal::start())) saved_ = false;
+        return true;
+    }
+
+    // Writes the book and batch as the next snapshot and switches to it;
+    // false if the book is unchanged
+    bool rebuild(const ContactBatch& batch) {
+        if (compactor_.joinable()) finishCompaction();
+        if (!path_.empty() && !saved_) return false; // The journal no longer matches memory
+        auto contents = [&](auto visit) {
+            forEach([&](ContactId, const ContactView& contact) { visit(contact); });
+            for (size_t i = 0; i < batch.size(); ++i) visit(batch.get(i));
+        };
+        uint64_t generation = base_.generation() + 1;
+
+        if (path_.empty()) {
+            int fd = ::memfd_create("contact-book", MFD_CLOEXEC);
+            MappedBook next;
+            bool written = fd >= 0 && writeBook(fd, generation, 0, contents) && next.open(fd);
+            if (fd >= 0) ::close(fd);
+            if (!written) return false;
+            base_.swap(next);
+            loadBase();
+            return true;
+        }
+
+        if (!installSnapshot(writeBook(path_ + ".tmp", generation, journal_.size(), contents))) return false;
+        if (base_.generation() != generation) {
+            // On disk but could not be mapped: add the batch in memory only
+            for (size_t i = 0; i < batch.size(); ++i) applyAdd(batch.get(i));
+        }
+        return true;
+    }
+
+    // Step 3: restart the journal at generation with the records from offset on
+    bool switchJournal(uint64_t offset, uint64_t generation) {
+        std::string records;
+        std::string tmp = journalPath() + ".tmp";
+        if (!journal_.readFrom(offset, records) || !Journal::create(tmp, generation, records) ||
+            std::rename(tmp.c_str(), journalPath().c_str()) != 0) {
+            return false;
+        }
+        bookfile::syncDirectory(path_);
+        return journal_.open(journalPath());
+    }
+
+    std::string path_;
+    size_t compactBytes_ = kDefaultCompactBytes;
+    MappedBook base_;
+    std::vector<uint8_t> removed_; // Per snapshot contact
+    size_t baseLive_ = 0;
+    ContactStore added_;           // Contacts added since the snapshot
+    mutable FuzzyIndex baseWords_; // Over live snapshot contacts, once baseWordsBuilt_
+    mutable bool baseWordsBuilt_ = false;
+    Journal journal_;
+    bool replaying_ = false;
+    bool saved_ = true;
+
+    std::thread compactor_;
+    std::atomic<bool> compactDone_{false};
+    bool compactOk_ = false; // Read after joining the thread
+    uint64_t compactOffset_ = 0;
+};
+
+#endif // CONTACT_BOOK_H
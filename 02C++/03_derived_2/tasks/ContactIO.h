@@ -0,0 +1,447 @@
+#ifndef CONTACT_IO_H
+#define CONTACT_IO_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "ContactBook.h"
+
+// Bulk import and export of contacts as CSV or JSON lines.
+//
+// CSV: one record per contact, name,phone,email, with fields quoted as in
+// RFC 4180 when they hold a comma, a quote or a line break. A first record
+// reading name,phone,email is a header and skipped. JSON lines: one object
+// per line with string members "name", "phone" and "email"; other members
+// are ignored, and a missing phone or email is empty. Records that do not
+// parse are skipped and counted.
+//
+// An import maps the file and parses it in place, without a std::string or
+// a stream extraction per line. The file is cut at record boundaries into a
+// chunk per core, the chunks are parsed side by side into ContactBatches,
+// and the lot goes to ContactBook::addContacts at once. An export formats
+// into a buffer written out a megabyte at a time.
+
+enum class ContactFormat { kCsv, kJsonLines };
+
+struct ImportResult {
+    size_t imported = 0;
+    size_t skipped = 0; // Malformed records
+};
+
+// From the extension: .csv, or .jsonl, .ndjson or .json for JSON lines
+inline bool contactFormatOf(const std::string& path, ContactFormat& format) {
+    size_t dot = path.rfind('.');
+    std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+    for (char& c : extension) c = foldChar(c);
+    if (extension == "csv") {
+        format = ContactFormat::kCsv;
+    } else if (extension == "jsonl" || extension == "ndjson" || extension == "json") {
+        format = ContactFormat::kJsonLines;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+namespace contactio {
+
+const size_t kOutputBlock = 1 << 20;
+const size_t kMinChunk = 4 << 20; // Smaller files are not worth a thread
+
+// Where the record holding text[at] ends, just past its line break
+inline size_t lineEnd(std::string_view text, size_t at) {
+    const void* newline = std::memchr(text.data() + at, '\n', text.size() - at);
+    return newline ? static_cast<size_t>(static_cast<const char*>(newline) - text.data()) + 1 : text.size();
+}
+
+// Offsets cutting text into about parts chunks that each start a record.
+// Only CSV can break a line inside a record, within quotes, so it tracks
+// them from the start; counting quotes runs far faster than parsing.
+inline std::vector<size_t> splitRecords(std::string_view text, ContactFormat format, size_t parts) {
+    std::vector<size_t> cuts{0};
+    size_t at = 0;
+    bool quoted = false;
+    for (size_t part = 1; part < parts; ++part) {
+        size_t target = std::max(at, text.size() / parts * part);
+        if (format == ContactFormat::kJsonLines) {
+            at = target == 0 ? 0 : lineEnd(text, target - 1);
+        } else {
+            quoted ^= std::count(text.begin() + static_cast<std::ptrdiff_t>(at),
+                                 text.begin() + static_cast<std::ptrdiff_t>(target), '"') % 2 == 1;
+            at = target;
+            while (at < text.size()) {
+                char c = text[at++];
+                if (c == '"') {
+                    quoted = !quoted;
+                } else if (c == '\n' && !quoted) {
+                    break;
+                }
+            }
+        }
+        if (at > cuts.back() && at < text.size()) cuts.push_back(at);
+    }
+    cuts.push_back(text.size());
+    return cuts;
+}
+
+// One CSV field from text[at] on, which is left past it; false if a quoted
+// field is not closed or runs into something other than a separator
+inline bool csvField(std::string_view text, size_t& at, std::string& scratch, std::string_view& field) {
+    if (at >= text.size() || text[at] != '"') {
+        size_t end = at;
+        while (end < text.size() && text[end] != ',' && text[end] != '\n') ++end;
+        size_t last = end > at && text[end - 1] == '\r' && (end == text.size() || text[end] == '\n') ? end - 1 : end;
+        field = text.substr(at, last - at);
+        at = end;
+        return true;
+    }
+    // Quoted: copy only when there is an escaped quote to take out
+    size_t start = ++at;
+    bool copied = false;
+    while (true) {
+        const void* quote = std::memchr(text.data() + at, '"', text.size() - at);
+        if (!quote) return false;
+        size_t q = static_cast<size_t>(static_cast<const char*>(quote) - text.data());
+        if (q + 1 < text.size() && text[q + 1] == '"') {
+            if (!copied) scratch.clear();
+            scratch.append(text.data() + at, q + 1 - at);
+            copied = true;
+            at = q + 2;
+            continue;
+        }
+        if (copied) {
+            scratch.append(text.data() + at, q - at);
+            field = scratch;
+        } else {
+            field = text.substr(start, q - start);
+        }
+        at = q + 1;
+        if (at < text.size() && text[at] == '\r') ++at;
+        return at == text.size() || text[at] == ',' || text[at] == '\n';
+    }
+}
+
+inline bool isCsvHeader(const std::string_view* fields) {
+    return compareFolded(fields[0], "name") == 0 && compareFolded(fields[1], "phone") == 0 &&
+           compareFolded(fields[2], "email") == 0;
+}
+
+inline void parseCsv(std::string_view text, bool first, ContactBatch& batch, size_t& skipped) {
+    std::string scratch[3], extra;
+    std::string_view fields[3];
+    size_t at = 0;
+    while (at < text.size()) {
+        if (text[at] == '\n' || (text[at] == '\r' && at + 1 < text.size() && text[at + 1] == '\n')) {
+            at += text[at] == '\n' ? 1 : 2; // Blank line
+            continue;
+        }
+        size_t count = 0;
+        bool ok = true;
+        while (true) {
+            std::string_view field;
+            if (!csvField(text, at, count < 3 ? scratch[count] : extra, field)) {
+                ok = false;
+                break;
+            }
+            if (count < 3) fields[count] = field;
+            ++count;
+            if (at >= text.size() || text[at] == '\n') break;
+            ++at; // Past the comma
+        }
+        if (!ok) {
+            // Resynchronise at the next line break
+            at = lineEnd(text, std::min(at, text.size()));
+            ++skipped;
+            continue;
+        }
+        if (at < text.size()) ++at; // Past the line break
+        if (count != 3) {
+            ++skipped;
+        } else if (!(first && isCsvHeader(fields))) {
+            batch.add({fields[0], fields[1], fields[2]});
+        }
+        first = false;
+    }
+}
+
+inline void appendUtf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xc0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xe0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+}
+
+inline bool hex4(std::string_view text, size_t at, uint32_t& code) {
+    if (text.size() < at + 4) return false;
+    code = 0;
+    for (size_t i = at; i < at + 4; ++i) {
+        char c = text[i];
+        uint32_t digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                       : c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16;
+        if (digit == 16) return false;
+        code = code << 4 | digit;
+    }
+    return true;
+}
+
+// A JSON string starting at the quote at text[at]; at is left past it. The
+// value is a view into text unless it has escapes to decode into scratch.
+inline bool jsonString(std::string_view text, size_t& at, std::string& scratch, std::string_view& value) {
+    size_t start = ++at;
+    while (at < text.size() && text[at] != '"' && text[at] != '\\') ++at;
+    if (at >= text.size()) return false;
+    if (text[at] == '"') {
+        value = text.substr(start, at - start);
+        ++at;
+        return true;
+    }
+    scratch.assign(text.data() + start, at - start);
+    while (at < text.size()) {
+        char c = text[at++];
+        if (c == '"') {
+            value = scratch;
+            return true;
+        }
+        if (c != '\\') {
+            scratch += c;
+            continue;
+        }
+        if (at >= text.size()) return false;
+        char e = text[at++];
+        uint32_t code;
+        switch (e) {
+            case '"': case '\\': case '/': scratch += e; break;
+            case 'b': scratch += '\b'; break;
+            case 'f': scratch += '\f'; break;
+            case 'n': scratch += '\n'; break;
+            case 'r': scratch += '\r'; break;
+            case 't': scratch += '\t'; break;
+            case 'u':
+                if (!hex4(text, at, code)) return false;
+                at += 4;
+                if (code >= 0xd800 && code < 0xdc00) {
+                    // A surrogate pair spells one code point above 0xffff
+                    uint32_t low;
+                    if (text.substr(at, 2) != "\\u" || !hex4(text, at + 2, low) || low < 0xdc00 || low >= 0xe000) {
+                        return false;
+                    }
+                    at += 6;
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                }
+                appendUtf8(scratch, code);
+                break;
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+inline void skipSpace(std::string_view text, size_t& at) {
+    while (at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == '\r')) ++at;
+}
+
+// One JSON object on a line; false if it is not one of string members
+inline bool jsonContact(std::string_view line, std::string* scratch, std::string& keyScratch,
+                        std::string_view* fields) {
+    static const char* const kKeys[3] = {"name", "phone", "email"};
+    bool seen[3] = {false, false, false};
+    size_t at = 0;
+    skipSpace(line, at);
+    if (at >= line.size() || line[at++] != '{') return false;
+    skipSpace(line, at);
+    bool more = at < line.size() && line[at] != '}';
+    while (more) {
+        std::string_view key, value;
+        std::string ignored;
+        if (at >= line.size() || line[at] != '"' || !jsonString(line, at, keyScratch, key)) return false;
+        int field = -1;
+        for (int f = 0; f < 3; ++f) {
+            if (key == kKeys[f]) field = f;
+        }
+        skipSpace(line, at);
+        if (at >= line.size() || line[at++] != ':') return false;
+        skipSpace(line, at);
+        if (at >= line.size() || line[at] != '"' ||
+            !jsonString(line, at, field >= 0 ? scratch[field] : ignored, value)) {
+            return false;
+        }
+        if (field >= 0) {
+            fields[field] = value;
+            seen[field] = true;
+        }
+        skipSpace(line, at);
+        if (at >= line.size()) return false;
+        more = line[at] == ',';
+        if (more) {
+            ++at;
+            skipSpace(line, at);
+        }
+    }
+    if (at >= line.size() || line[at++] != '}') return false;
+    skipSpace(line, at);
+    if (!seen[1]) fields[1] = std::string_view();
+    if (!seen[2]) fields[2] = std::string_view();
+    return at == line.size() && seen[0];
+}
+
+inline void parseJsonLines(std::string_view text, ContactBatch& batch, size_t& skipped) {
+    std::string scratch[3], keyScratch;
+    std::string_view fields[3];
+    for (size_t at = 0; at < text.size();) {
+        size_t end = lineEnd(text, at);
+        std::string_view line = text.substr(at, end - at);
+        at = end;
+        if (!line.empty() && line.back() == '\n') line.remove_suffix(1);
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+        if (jsonContact(line, scratch, keyScratch, fields)) {
+            batch.add({fields[0], fields[1], fields[2]});
+        } else {
+            ++skipped;
+        }
+    }
+}
+
+// Parses text side by side into batch, in file order
+inline void parseContacts(std::string_view text, ContactFormat format, ContactBatch& batch, size_t& skipped) {
+    if (text.substr(0, 3) == "\xEF\xBB\xBF") text.remove_prefix(3); // UTF-8 byte order mark
+    size_t parts = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), text.size() / kMinChunk));
+    std::vector<size_t> cuts = splitRecords(text, format, parts);
+    size_t chunks = cuts.size() - 1;
+    std::vector<ContactBatch> parsed(chunks > 1 ? chunks - 1 : 0); // The first chunk goes straight to batch
+    std::vector<size_t> chunkSkipped(chunks, 0);
+    bookfile::parallelFor(chunks, [&](size_t chunk) {
+        std::string_view part = text.substr(cuts[chunk], cuts[chunk + 1] - cuts[chunk]);
+        ContactBatch& out = chunk == 0 ? batch : parsed[chunk - 1];
+        if (format == ContactFormat::kCsv) {
+            parseCsv(part, chunk == 0, out, chunkSkipped[chunk]);
+        } else {
+            parseJsonLines(part, out, chunkSkipped[chunk]);
+        }
+    });
+    for (const ContactBatch& part : parsed) batch.append(part);
+    for (size_t count : chunkSkipped) skipped += count;
+}
+
+inline void appendCsvField(std::string& out, std::string_view field) {
+    if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out.append(field);
+        return;
+    }
+    out += '"';
+    for (char c : field) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+inline void appendJsonString(std::string& out, std::string_view text) {
+    static const char kHex[] = "0123456789abcdef";
+    out += '"';
+    size_t plain = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.append(text.data() + plain, i - plain);
+        plain = i + 1;
+        out += '\\';
+        switch (c) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '\n': out += 'n'; break;
+            case '\r': out += 'r'; break;
+            case '\t': out += 't'; break;
+            default: out.append("u00").append(1, kHex[c >> 4]).append(1, kHex[c & 15]); break;
+        }
+    }
+    out.append(text.data() + plain, text.size() - plain);
+    out += '"';
+}
+
+inline void appendContact(std::string& out, ContactFormat format, const ContactView& contact) {
+    if (format == ContactFormat::kCsv) {
+        appendCsvField(out, contact.name);
+        out += ',';
+        appendCsvField(out, contact.phone);
+        out += ',';
+        appendCsvField(out, contact.email);
+        out += '\n';
+        return;
+    }
+    out.append("{\"name\":");
+    appendJsonString(out, contact.name);
+    out.append(",\"phone\":");
+    appendJsonString(out, contact.phone);
+    out.append(",\"email\":");
+    appendJsonString(out, contact.email);
+    out.append("}\n");
+}
+
+} // namespace contactio
+
+// Adds the contacts in the file at path to book; false if it cannot be read
+inline bool importContactFile(ContactBook& book, const std::string& path, ContactFormat format, ImportResult& result) {
+    result = ImportResult();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = size > 0 ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+    if (size > 0) ::madvise(data, size, MADV_SEQUENTIAL);
+
+    ContactBatch batch;
+    contactio::parseContacts(std::string_view(static_cast<const char*>(data), size), format, batch, result.skipped);
+    if (size > 0) ::munmap(data, size);
+    book.addContacts(batch);
+    result.imported = batch.size();
+    return true;
+}
+
+// Writes every contact of book to path, a CSV file with a header line or
+// JSON lines; false if the file cannot be written
+inline bool exportContactFile(const ContactBook& book, const std::string& path, ContactFormat format) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    std::string out;
+    out.reserve(contactio::kOutputBlock + 1024);
+    if (format == ContactFormat::kCsv) out.append("name,phone,email\n");
+    bool ok = true;
+    book.forEach([&](ContactId, const ContactView& contact) {
+        contactio::appendContact(out, format, contact);
+        if (out.size() >= contactio::kOutputBlock) {
+            ok = ok && std::fwrite(out.data(), 1, out.size(), file) == out.size();
+            out.clear();
+        }
+    });
+    ok = ok && std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+#endif // CONTACT_IO_H
@@ -0,0 +1,225 @@
+#ifndef CONTACT_STORE_H
+#define CONTACT_STORE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "FlatIndex.h"
+#include "SearchIndex.h"
+#include "StringColumn.h"
+
+struct Contact {
+    std::string name;
+    std::string phone;
+    std::string email;
+};
+
+// A stored contact, read in place; valid until the store is next modified
+struct ContactView {
+    std::string_view name;
+    std::string_view phone;
+    std::string_view email;
+};
+
+using ContactId = uint32_t;
+
+// Contact storage with hash indexes on name, phone and email.
+//
+// Contacts live in slots addressed by ContactId; a removed contact's slot is
+// reused by a later add. The fields are kept column by column, each in its
+// own string arena (see StringColumn.h), rather than as three std::strings
+// per contact. Names (and phones, emails) need not be unique: a
+// lookup reports every contact with that key, lowest id first. Names are also
+// indexed for prefix and fuzzy search (see SearchIndex.h).
+class ContactStore {
+public:
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    // A field too long for what its column still holds (see
+    // StringColumn::fits()) is stored empty
+    ContactId add(ContactView contact) {
+        ContactId id;
+        if (!freeSlots_.empty()) {
+            id = freeSlots_.back();
+            freeSlots_.pop_back();
+            names_.set(id, contact.name);
+            phones_.set(id, contact.phone);
+            emails_.set(id, contact.email);
+            live_[id] = 1;
+        } else {
+            id = static_cast<ContactId>(live_.size());
+            names_.push(contact.name);
+            phones_.push(contact.phone);
+            emails_.push(contact.email);
+            live_.push_back(1);
+        }
+        insertKey(byName_, &ContactStore::names_, id);
+        insertKey(byPhone_, &ContactStore::phones_, id);
+        insertKey(byEmail_, &ContactStore::emails_, id);
+        byPrefix_.insert(id, nameOf());
+        byWords_.insert(id, names_.get(id));
+        ++count_;
+        return id;
+    }
+
+    bool remove(ContactId id) {
+        if (!contains(id)) return false;
+        byName_.erase(indexHash(names_.get(id)), id);
+        byPhone_.erase(indexHash(phones_.get(id)), id);
+        byEmail_.erase(indexHash(emails_.get(id)), id);
+        byPrefix_.erase(id, nameOf());
+        byWords_.erase(id, names_.get(id));
+        // Release the bytes now, not when the slot is reused
+        names_.release(id);
+        phones_.release(id);
+        emails_.release(id);
+        live_[id] = 0;
+        freeSlots_.push_back(id);
+        --count_;
+        return true;
+    }
+
+    // Replace phone and email, keeping the secondary indexes in step; false,
+    // changing nothing, if either does not fit its column
+    bool update(ContactId id, std::string_view phone, std::string_view email) {
+        if (!contains(id) || !phones_.fits(phone) || !emails_.fits(email)) return false;
+        byPhone_.erase(indexHash(phones_.get(id)), id);
+        byEmail_.erase(indexHash(emails_.get(id)), id);
+        phones_.set(id, phone);
+        emails_.set(id, email);
+        insertKey(byPhone_, &ContactStore::phones_, id);
+        insertKey(byEmail_, &ContactStore::emails_, id);
+        return true;
+    }
+
+    void clear() {
+        names_.clear();
+        phones_.clear();
+        emails_.clear();
+        live_.clear();
+        freeSlots_.clear();
+        byName_.clear();
+        byPhone_.clear();
+        byEmail_.clear();
+        byPrefix_.clear();
+        byWords_.clear();
+        count_ = 0;
+    }
+
+    void reserve(size_t count) {
+        names_.reserve(count, 0);
+        phones_.reserve(count, 0);
+        emails_.reserve(count, 0);
+        live_.reserve(count);
+        byName_.reserve(count);
+        byPhone_.reserve(count);
+        byEmail_.reserve(count);
+    }
+
+    bool contains(ContactId id) const { return id < live_.size() && live_[id]; }
+    ContactView get(ContactId id) const { return {names_.get(id), phones_.get(id), emails_.get(id)}; }
+
+    std::vector<ContactId> findByName(std::string_view name) const { return find(byName_, &ContactStore::names_, name); }
+    std::vector<ContactId> findByPhone(std::string_view phone) const { return find(byPhone_, &ContactStore::phones_, phone); }
+    std::vector<ContactId> findByEmail(std::string_view email) const { return find(byEmail_, &ContactStore::emails_, email); }
+
+    // Up to limit contacts whose name starts with prefix, ignoring case, by name
+    std::vector<ContactId> findByPrefix(std::string_view prefix, size_t limit) const {
+        return byPrefix_.find(prefix, limit, nameOf());
+    }
+
+    // Up to limit contacts whose name words are each within maxDistance edits
+    // of a query word, closest first
+    std::vector<ContactId> findFuzzy(std::string_view query, int maxDistance, size_t limit) const {
+        std::vector<ContactId> ids;
+        for (const auto& match : findFuzzyRanked(query, maxDistance, limit)) {
+            ids.push_back(match.first);
+        }
+        return ids;
+    }
+
+    // Same, with the number of edits of each match
+    std::vector<std::pair<ContactId, int>> findFuzzyRanked(std::string_view query, int maxDistance, size_t limit) const {
+        return byWords_.find(query, maxDistance, limit, nameOf());
+    }
+
+    // Call visit(id, contact) for every stored contact in id order
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (size_t id = 0; id < live_.size(); ++id) {
+            if (live_[id]) visit(static_cast<ContactId>(id), get(static_cast<ContactId>(id)));
+        }
+    }
+
+private:
+    // Name of a contact id, as the prefix index reads it
+    struct NameOf {
+        const ContactStore* store;
+        std::string_view operator()(uint32_t id) const { return store->names_.get(id); }
+    };
+
+    NameOf nameOf() const { return {this}; }
+
+    void insertKey(FlatIndex& index, StringColumn ContactStore::*column, ContactId id) {
+        std::string_view key = (this->*column).get(id);
+        index.insert(indexHash(key), id, [&](uint32_t other) { return (this->*column).get(other) == key; });
+    }
+
+    std::vector<ContactId> find(const FlatIndex& index, StringColumn ContactStore::*column, std::string_view key) const {
+        std::vector<ContactId> ids;
+        index.find(indexHash(key),
+                   [&](uint32_t id) { return (this->*column).get(id) == key; },
+                   [&](uint32_t id) { ids.push_back(id); });
+        if (ids.size() > 1) std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    StringColumn names_;                 // Rows indexed by ContactId
+    StringColumn phones_;
+    StringColumn emails_;
+    std::vector<uint8_t> live_;          // 0 for a removed contact's slot
+    std::vector<ContactId> freeSlots_;
+    FlatIndex byName_;
+    FlatIndex byPhone_;
+    FlatIndex byEmail_;
+    PrefixIndex byPrefix_;
+    FuzzyIndex byWords_;
+    size_t count_ = 0;
+};
+
+// Contacts gathered for a bulk add (ContactBook::addContacts), kept column by
+// column like ContactStore but without indexes
+class ContactBatch {
+public:
+    size_t size() const { return names_.size(); }
+    bool empty() const { return names_.size() == 0; }
+
+    void add(ContactView contact) {
+        names_.push(contact.name);
+        phones_.push(contact.phone);
+        emails_.push(contact.email);
+    }
+
+    ContactView get(size_t i) const { return {names_.get(i), phones_.get(i), emails_.get(i)}; }
+
+    void append(const ContactBatch& other) {
+        for (size_t i = 0; i < other.size(); ++i) add(other.get(i));
+    }
+
+    void clear() {
+        names_.clear();
+        phones_.clear();
+        emails_.clear();
+    }
+
+private:
+    StringColumn names_;
+    StringColumn phones_;
+    StringColumn emails_;
+};
+
+#endif // CONTACT_STORE_H
@@ -0,0 +1,235 @@
+#ifndef FLAT_INDEX_H
+#define FLAT_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Open-addressing hash index from a key to the 32-bit ids of the records
+// holding that key.
+//
+// Each distinct key takes one 8-byte slot (hash, first id) in a flat array
+// with linear probing, so a lookup usually touches one cache line. Further
+// records with the same key hang off the first one in a doubly linked chain,
+// which keeps inserts and removals O(1) however many duplicates a key has.
+// The index never stores keys: callers pass a predicate that compares the
+// key of a record id. Erasing shifts later slots back instead of leaving
+// tombstones, so probe sequences stay short under heavy removal. The slots
+// and the next-record chains can be saved and searched in place with the
+// static find().
+
+inline uint32_t indexHash(std::string_view key) {
+    uint64_t h = std::hash<std::string_view>()(key);
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+class FlatIndex {
+public:
+    static constexpr uint32_t kNone = 0xffffffffu;
+
+    struct Slot {
+        uint32_t hash;
+        uint32_t id; // First record with this key
+    };
+
+    FlatIndex() : mask_(0), keys_(0) {}
+
+    // Distinct keys
+    size_t size() const { return keys_; }
+
+    void clear() {
+        slots_.clear();
+        next_.clear();
+        prev_.clear();
+        mask_ = 0;
+        keys_ = 0;
+    }
+
+    void reserve(size_t count) {
+        size_t capacity = 16;
+        while (capacity < count * 2) capacity *= 2;
+        if (capacity > slots_.size()) rehash(capacity);
+        next_.reserve(count);
+        prev_.reserve(count);
+    }
+
+    // Add id under hash; sameKey(other) tells whether record other has id's key
+    template <typename SameKey>
+    void insert(uint32_t hash, uint32_t id, SameKey sameKey) {
+        if (id >= next_.size()) {
+            next_.resize(id + 1, kNone);
+            prev_.resize(id + 1, kNone);
+        }
+        if (!slots_.empty()) {
+            size_t i = hash & mask_;
+            while (slots_[i].id != kNone) {
+                if (slots_[i].hash == hash && sameKey(slots_[i].id)) {
+                    // Link in right after the first record of the key
+                    uint32_t head = slots_[i].id;
+                    next_[id] = next_[head];
+                    prev_[id] = head;
+                    if (next_[head] != kNone) prev_[next_[head]] = id;
+                    next_[head] = id;
+                    return;
+                }
+                i = (i + 1) & mask_;
+            }
+        }
+
+        if ((keys_ + 1) * 2 > slots_.size()) {
+            rehash(slots_.empty() ? 16 : slots_.size() * 2);
+        }
+        size_t i = hash & mask_;
+        while (slots_[i].id != kNone) i = (i + 1) & mask_;
+        slots_[i] = {hash, id};
+        next_[id] = kNone;
+        prev_[id] = kNone;
+        ++keys_;
+    }
+
+    // Replace the contents with records 0..count-1, where hashOf(id) is the
+    // hash of a record's key and sameKey(a, b) tells whether two records share
+    // it. Inserting in home slot order keeps every probe in cache, which
+    // makes this several times faster than count single inserts.
+    template <typename HashOf, typename SameKey>
+    void build(uint32_t count, HashOf hashOf, SameKey sameKey) {
+        clear();
+        reserve(count);
+        if (slots_.empty()) rehash(16);
+        next_.assign(count, kNone);
+        prev_.assign(count, kNone);
+
+        // (hash, id) pairs by home slot, radix sorted on the home bits
+        std::vector<Slot> order(count), sorted(count);
+        for (uint32_t id = 0; id < count; ++id) order[id] = {hashOf(id), id};
+        int bits = 0;
+        while ((size_t(1) << bits) < slots_.size()) ++bits;
+        for (int shift = 0; shift < bits; shift += 11) {
+            size_t counts[2049] = {};
+            for (const Slot& entry : order) ++counts[((entry.hash & mask_) >> shift & 2047) + 1];
+            for (size_t digit = 1; digit < 2049; ++digit) counts[digit] += counts[digit - 1];
+            for (const Slot& entry : order) sorted[counts[(entry.hash & mask_) >> shift & 2047]++] = entry;
+            order.swap(sorted);
+        }
+
+        // Slot order: a key's slot is at or after its home, and a duplicate
+        // finds its key's slot among those filled since
+        for (const Slot& entry : order) {
+            size_t i = entry.hash & mask_;
+            while (slots_[i].id != kNone &&
+                   !(slots_[i].hash == entry.hash && sameKey(entry.id, slots_[i].id))) {
+                i = (i + 1) & mask_;
+            }
+            if (slots_[i].id == kNone) {
+                slots_[i] = entry;
+                ++keys_;
+                continue;
+            }
+            uint32_t head = slots_[i].id;
+            next_[entry.id] = next_[head];
+            prev_[entry.id] = head;
+            if (next_[head] != kNone) prev_[next_[head]] = entry.id;
+            next_[head] = entry.id;
+        }
+    }
+
+    // Remove id, which was inserted under hash
+    void erase(uint32_t hash, uint32_t id) {
+        if (id >= prev_.size()) return;
+        if (prev_[id] != kNone) {
+            // Not the first record of its key: just unlink it
+            next_[prev_[id]] = next_[id];
+            if (next_[id] != kNone) prev_[next_[id]] = prev_[id];
+            prev_[id] = next_[id] = kNone;
+            return;
+        }
+
+        size_t i = hash & mask_;
+        while (!slots_.empty() && slots_[i].id != kNone) {
+            if (slots_[i].id == id) {
+                uint32_t successor = next_[id];
+                if (successor != kNone) {
+                    slots_[i].id = successor;
+                    prev_[successor] = kNone;
+                    next_[id] = kNone;
+                } else {
+                    shiftBack(i);
+                    --keys_;
+                }
+                return;
+            }
+            i = (i + 1) & mask_;
+        }
+    }
+
+    // Call visit(id) for every record whose key matches (isKey(id) is checked
+    // on the first record of each candidate key)
+    template <typename IsKey, typename Visit>
+    void find(uint32_t hash, IsKey isKey, Visit visit) const {
+        find(slots_.data(), slots_.size(), next_.data(), hash, isKey, visit);
+    }
+
+    // Same, over tables saved from slots() and chains(); slotCount is zero
+    // or a power of two
+    template <typename IsKey, typename Visit>
+    static void find(const Slot* slots, size_t slotCount, const uint32_t* next, uint32_t hash, IsKey isKey,
+                     Visit visit) {
+        if (slotCount == 0) return;
+        size_t mask = slotCount - 1;
+        size_t i = hash & mask;
+        while (slots[i].id != kNone) {
+            if (slots[i].hash == hash && isKey(slots[i].id)) {
+                for (uint32_t id = slots[i].id; id != kNone; id = next[id]) {
+                    visit(id);
+                }
+                return;
+            }
+            i = (i + 1) & mask;
+        }
+    }
+
+    const std::vector<Slot>& slots() const { return slots_; }
+    const std::vector<uint32_t>& chains() const { return next_; } // Per record id: next with the same key
+
+private:
+    void rehash(size_t capacity) {
+        std::vector<Slot> old;
+        old.swap(slots_);
+        slots_.assign(capacity, Slot{0, kNone});
+        mask_ = capacity - 1;
+        for (const Slot& slot : old) {
+            if (slot.id == kNone) continue;
+            size_t i = slot.hash & mask_;
+            while (slots_[i].id != kNone) i = (i + 1) & mask_;
+            slots_[i] = slot;
+        }
+    }
+
+    // Fill the hole at i with a later slot of the same probe sequence, repeatedly
+    void shiftBack(size_t hole) {
+        size_t i = hole;
+        while (true) {
+            i = (i + 1) & mask_;
+            if (slots_[i].id == kNone) break;
+            size_t home = slots_[i].hash & mask_;
+            // The slot may move into the hole only if its home is not
+            // cyclically inside (hole, i]
+            bool inRange = hole <= i ? (home > hole && home <= i) : (home > hole || home <= i);
+            if (!inRange) {
+                slots_[hole] = slots_[i];
+                hole = i;
+            }
+        }
+        slots_[hole] = Slot{0, kNone};
+    }
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> next_; // Per record id: next record with the same key
+    std::vector<uint32_t> prev_; // Per record id: previous one, kNone for the first
+    size_t mask_;
+    size_t keys_;
+};
+
+#endif // FLAT_INDEX_H
@@ -0,0 +1,220 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Append-only log of address book changes, replayed on top of a snapshot.
+//
+// Layout: a JournalHeader, then records: a 32-bit payload size, the CRC-32 of
+// the payload, and the payload (an operation byte, then each field as a
+// 32-bit length and its bytes). Every record goes out in one write(), so a
+// process killed mid-append leaves at most one torn record at the end.
+// Replay stops at the first record that is short or fails its CRC, and the
+// file is cut there before anything else is appended.
+//
+// Records are not synced one by one: a change survives the process being
+// killed as soon as append() returns, and a power failure once sync() has.
+
+const char kJournalMagic[8] = {'A', 'B', 'J', 'R', 'N', 'L', '0', '1'};
+
+struct JournalHeader {
+    char magic[8];
+    uint64_t generation; // Matches the snapshot it applies to
+};
+
+enum JournalOp : uint8_t {
+    kAddContact = 1, // name, phone, email
+    kRemoveByName,   // name
+    kUpdateByName,   // name, phone, email
+    kClearBook,
+};
+
+inline uint32_t crc32(const char* data, size_t size) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+class Journal {
+public:
+    static const size_t kMaxFields = 3;
+
+    Journal() : fd_(-1), generation_(0), end_(0) {}
+    ~Journal() { close(); }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Writes a journal holding the given records (as read by readFrom) and syncs it
+    static bool create(const std::string& path, uint64_t generation, std::string_view records) {
+        JournalHeader header;
+        std::memcpy(header.magic, kJournalMagic, sizeof(header.magic));
+        header.generation = generation;
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        bool ok = writeAll(fd, &header, sizeof(header)) && writeAll(fd, records.data(), records.size()) &&
+                  ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    // False if path is missing or not a journal
+    bool open(const std::string& path) {
+        close();
+        fd_ = ::open(path.c_str(), O_RDWR | O_APPEND | O_CLOEXEC);
+        if (fd_ < 0) return false;
+        JournalHeader header;
+        struct stat st;
+        if (::pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            std::memcmp(header.magic, kJournalMagic, sizeof(header.magic)) != 0 || ::fstat(fd_, &st) != 0) {
+            close();
+            return false;
+        }
+        generation_ = header.generation;
+        end_ = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+
+    void close() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        generation_ = 0;
+        end_ = 0;
+    }
+
+    bool isOpen() const { return fd_ >= 0; }
+    uint64_t generation() const { return generation_; }
+    uint64_t size() const { return end_; }
+    static uint64_t start() { return sizeof(JournalHeader); }
+
+    // Adds a record to the end of records, to append several in one write
+    static void encode(std::string& records, JournalOp op, std::initializer_list<std::string_view> fields) {
+        size_t at = records.size();
+        records.append(8, '\0');
+        records += static_cast<char>(op);
+        for (std::string_view field : fields) {
+            uint32_t length = static_cast<uint32_t>(field.size());
+            records.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            records.append(field.data(), field.size());
+        }
+        uint32_t size = static_cast<uint32_t>(records.size() - at - 8);
+        uint32_t crc = crc32(records.data() + at + 8, size);
+        std::memcpy(&records[at], &size, sizeof(size));
+        std::memcpy(&records[at + 4], &crc, sizeof(crc));
+    }
+
+    bool append(JournalOp op, std::initializer_list<std::string_view> fields) {
+        std::string record;
+        encode(record, op, fields);
+        return append(record);
+    }
+
+    // Appends records made by encode(). A crash during the write keeps an
+    // intact prefix of them.
+    bool append(std::string_view records) {
+        if (fd_ < 0) return false;
+        if (!writeAll(fd_, records.data(), records.size())) {
+            // Cut a partial record off again so that later ones are not
+            // stranded behind it; should that fail too, replay cuts it
+            int cut = ::ftruncate(fd_, static_cast<off_t>(end_));
+            (void)cut;
+            return false;
+        }
+        end_ += records.size();
+        return true;
+    }
+
+    bool sync() { return fd_ < 0 || ::fdatasync(fd_) == 0; }
+
+    // The raw records from offset to the end
+    bool readFrom(uint64_t offset, std::string& records) const {
+        records.clear();
+        if (fd_ < 0 || offset > end_) return false;
+        records.resize(static_cast<size_t>(end_ - offset));
+        size_t done = 0;
+        while (done < records.size()) {
+            ssize_t n = ::pread(fd_, &records[done], records.size() - done, static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Call visit(op, fields, fieldCount) for each intact record from offset
+    // on, then cut off whatever follows the last one
+    template <typename Visit>
+    bool replay(uint64_t offset, Visit visit) {
+        std::string records;
+        if (!readFrom(offset, records)) return false;
+        size_t at = 0;
+        std::string_view fields[kMaxFields];
+        while (records.size() - at >= 8) {
+            uint32_t size, crc;
+            std::memcpy(&size, &records[at], sizeof(size));
+            std::memcpy(&crc, &records[at + 4], sizeof(crc));
+            if (size == 0 || size > records.size() - at - 8 || crc32(&records[at + 8], size) != crc) break;
+
+            std::string_view payload(&records[at + 8], size);
+            JournalOp op = static_cast<JournalOp>(payload[0]);
+            size_t count = 0;
+            size_t p = 1;
+            while (p < payload.size() && count < kMaxFields) {
+                uint32_t length;
+                if (payload.size() - p < sizeof(length)) break;
+                std::memcpy(&length, payload.data() + p, sizeof(length));
+                p += sizeof(length);
+                if (length > payload.size() - p) break;
+                fields[count++] = payload.substr(p, length);
+                p += length;
+            }
+            if (p != payload.size()) break; // Intact but not ours: stop as for a torn record
+            visit(op, fields, count);
+            at += 8 + size;
+        }
+        if (offset + at < end_) {
+            if (::ftruncate(fd_, static_cast<off_t>(offset + at)) != 0) return false;
+            end_ = offset + at;
+        }
+        return true;
+    }
+
+private:
+    static bool writeAll(int fd, const void* data, size_t size) {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t n = ::write(fd, p, size);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    int fd_;
+    uint64_t generation_;
+    uint64_t end_;
+};
+
+#endif // JOURNAL_H
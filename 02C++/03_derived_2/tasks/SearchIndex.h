@@ -0,0 +1,630 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Search-as-you-type indexes over record names, both updated per record.
+//
+// PrefixIndex keeps record ids sorted by case-folded name in blocks of at
+// most kMaxBlock entries: a prefix lookup is a binary search over the blocks
+// and then within one, and an insert or erase moves at most one block. Each
+// entry carries the first 8 folded bytes of its name, so most comparisons
+// never touch the name itself. A flat sorted array of entries (as saved to a
+// file) can be searched with the static scan().
+//
+// FuzzyIndex splits names into lowercase words and indexes each distinct
+// word under every string obtained by deleting up to maxDistance letters from
+// it. Two words within maxDistance edits always share such a deletion, so a
+// query only looks up its own deletions and verifies the few words found.
+// Since names share words, the index grows with the vocabulary, not with the
+// number of records.
+
+// ASCII lowercase; cheaper than std::tolower, which consults the locale
+inline char foldChar(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c;
+}
+
+inline bool isWordChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+// Case-insensitive three-way compare
+inline int compareFolded(std::string_view a, std::string_view b) {
+    size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) {
+        char x = foldChar(a[i]);
+        char y = foldChar(b[i]);
+        if (x != y) return static_cast<unsigned char>(x) < static_cast<unsigned char>(y) ? -1 : 1;
+    }
+    return a.size() < b.size() ? -1 : a.size() > b.size() ? 1 : 0;
+}
+
+inline bool startsWithFolded(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && compareFolded(text.substr(0, prefix.size()), prefix) == 0;
+}
+
+class PrefixIndex {
+public:
+    struct Entry {
+        uint64_t head; // First 8 folded bytes of the name, big-endian, zero padded
+        uint32_t id;
+    };
+
+    static Entry entryOf(uint32_t id, std::string_view key) { return {headOf(key), id}; }
+
+    // Name order, ties broken by id
+    template <typename KeyOf>
+    static bool less(const Entry& a, const Entry& b, KeyOf& keyOf) {
+        if (a.head != b.head) return a.head < b.head;
+        int order = compareFolded(keyOf(a.id), keyOf(b.id));
+        return order != 0 ? order < 0 : a.id < b.id;
+    }
+
+    // Sort entries into name order: a radix sort on the heads, then the
+    // entries whose heads tie by the next 8 folded bytes and the length,
+    // which settles names of up to 16 bytes. Those bytes are read up front
+    // in the entries' order, which is sequential through the names, rather
+    // than at random once sorted.
+    template <typename KeyOf>
+    static void sortEntries(std::vector<Entry>& entries, KeyOf keyOf) {
+        struct Keyed {
+            uint64_t head;
+            uint64_t next; // Folded bytes 8 to 15, as in head
+            uint32_t id;
+            uint32_t length;
+        };
+        std::vector<Keyed> keyed(entries.size()), sorted(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            std::string_view name = keyOf(entries[i].id);
+            keyed[i] = {entries[i].head, headOf(name.size() > 8 ? name.substr(8) : std::string_view()), entries[i].id,
+                        static_cast<uint32_t>(std::min<size_t>(name.size(), 0xffffffffu))};
+        }
+        for (int shift = 0; shift < 64; shift += 16) {
+            std::vector<size_t> counts(65537, 0);
+            for (const Keyed& entry : keyed) ++counts[((entry.head >> shift) & 0xffff) + 1];
+            if (counts[1] == keyed.size()) continue; // Digit all zero, as for short names
+            for (size_t digit = 1; digit < counts.size(); ++digit) counts[digit] += counts[digit - 1];
+            for (const Keyed& entry : keyed) sorted[counts[(entry.head >> shift) & 0xffff]++] = entry;
+            keyed.swap(sorted);
+        }
+        // Where the padded bytes agree, the shorter name is a prefix of the
+        // longer, so goes first
+        forEachTie(keyed.data(), keyed.size(), [](const Keyed& entry) { return entry.head; },
+                   [](Keyed* tie, size_t count) {
+                       std::sort(tie, tie + count, [](const Keyed& a, const Keyed& b) {
+                           if (a.next != b.next) return a.next < b.next;
+                           return a.length != b.length ? a.length < b.length : a.id < b.id;
+                       });
+                   });
+        for (size_t i = 0; i < keyed.size(); ++i) entries[i] = {keyed[i].head, keyed[i].id};
+
+        // Longer names agreeing on 16 bytes come last in their run
+        forEachTie(keyed.data(), keyed.size(), [](const Keyed& entry) { return std::make_pair(entry.head, entry.next); },
+                   [&](Keyed* tie, size_t count) {
+                       Keyed* longer = std::find_if(tie, tie + count, [](const Keyed& entry) { return entry.length > 16; });
+                       size_t n = static_cast<size_t>(tie + count - longer);
+                       if (n > 1) sortTie(&entries[static_cast<size_t>(longer - keyed.data())], n, 2, keyOf);
+                   });
+    }
+
+    // Call visit(id) for the entries of a sorted array whose name starts with
+    // prefix, in order, until visit returns false
+    template <typename KeyOf, typename Visit>
+    static void scan(const Entry* entries, size_t count, std::string_view prefix, KeyOf keyOf, Visit visit) {
+        Query query(prefix);
+        const Entry* it = std::partition_point(entries, entries + count, [&](const Entry& entry) {
+            return query.below(entry, keyOf);
+        });
+        for (; it != entries + count && query.matches(*it, keyOf); ++it) {
+            if (!visit(it->id)) return;
+        }
+    }
+
+    void clear() { blocks_.clear(); }
+
+    // keyOf(id) returns the name of a record; it must not change while indexed
+    template <typename KeyOf>
+    void insert(uint32_t id, KeyOf keyOf) {
+        if (blocks_.empty()) blocks_.emplace_back();
+        Entry entry{headOf(keyOf(id)), id};
+        size_t b = blockFor(entry, keyOf);
+        std::vector<Entry>& block = blocks_[b];
+        block.insert(std::upper_bound(block.begin(), block.end(), entry, [&](const Entry& a, const Entry& other) {
+            return less(a, other, keyOf);
+        }), entry);
+        if (block.size() > kMaxBlock) {
+            std::vector<Entry> upper(block.begin() + kMaxBlock / 2, block.end());
+            block.resize(kMaxBlock / 2);
+            blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(b) + 1, std::move(upper));
+        }
+    }
+
+    // Call before the record's name changes or goes away
+    template <typename KeyOf>
+    void erase(uint32_t id, KeyOf keyOf) {
+        if (blocks_.empty()) return;
+        Entry entry{headOf(keyOf(id)), id};
+        size_t b = blockFor(entry, keyOf);
+        std::vector<Entry>& block = blocks_[b];
+        auto it = std::lower_bound(block.begin(), block.end(), entry, [&](const Entry& other, const Entry& a) {
+            return less(other, a, keyOf);
+        });
+        if (it == block.end() || it->id != id) return;
+        block.erase(it);
+        if (block.empty() && blocks_.size() > 1) {
+            blocks_.erase(blocks_.begin() + static_cast<std::ptrdiff_t>(b));
+        }
+    }
+
+    // Up to limit ids whose name starts with prefix (ignoring case), in name order
+    template <typename KeyOf>
+    std::vector<uint32_t> find(std::string_view prefix, size_t limit, KeyOf keyOf) const {
+        std::vector<uint32_t> ids;
+        Query query(prefix);
+        auto below = [&](const Entry& entry) { return query.below(entry, keyOf); };
+
+        size_t b = std::partition_point(blocks_.begin(), blocks_.end(), [&](const std::vector<Entry>& block) {
+            return !block.empty() && below(block.back());
+        }) - blocks_.begin();
+        for (; b < blocks_.size() && ids.size() < limit; ++b) {
+            const std::vector<Entry>& block = blocks_[b];
+            auto it = std::partition_point(block.begin(), block.end(), below);
+            for (; it != block.end() && ids.size() < limit; ++it) {
+                if (!query.matches(*it, keyOf)) return ids;
+                ids.push_back(it->id);
+            }
+        }
+        return ids;
+    }
+
+private:
+    static const size_t kMaxBlock = 1024;
+
+    // A prefix, with its head and the mask of the head bytes it fills
+    struct Query {
+        explicit Query(std::string_view text)
+            : prefix(text), head(headOf(text)), shortPrefix(text.size() <= sizeof(head)),
+              mask(text.size() >= sizeof(head) ? ~0ULL : ~(~0ULL >> (text.size() * 8))) {}
+
+        // Entries below the prefix sort before every match
+        template <typename KeyOf>
+        bool below(const Entry& entry, KeyOf& keyOf) const {
+            if (entry.head != head) return entry.head < head;
+            return !shortPrefix && compareFolded(keyOf(entry.id), prefix) < 0;
+        }
+
+        template <typename KeyOf>
+        bool matches(const Entry& entry, KeyOf& keyOf) const {
+            if ((entry.head & mask) != head) return false;
+            return shortPrefix || startsWithFolded(keyOf(entry.id), prefix);
+        }
+
+        std::string_view prefix;
+        uint64_t head;
+        bool shortPrefix;
+        uint64_t mask;
+    };
+
+    // Call sortRun(first, count) for each run of more than one entry with
+    // equal key(entry)
+    template <typename T, typename Key, typename SortRun>
+    static void forEachTie(T* entries, size_t count, Key key, SortRun sortRun) {
+        for (size_t begin = 0; begin < count;) {
+            size_t end = begin + 1;
+            while (end < count && key(entries[end]) == key(entries[begin])) ++end;
+            if (end - begin > 1) sortRun(entries + begin, end - begin);
+            begin = end;
+        }
+    }
+
+    // Sort entries whose names agree on their first depth * 8 folded bytes
+    template <typename KeyOf>
+    static void sortTie(Entry* entries, size_t count, size_t depth, KeyOf& keyOf) {
+        struct Keyed {
+            uint64_t next; // Folded bytes depth * 8 onwards, as in head
+            Entry entry;
+        };
+        std::vector<Keyed> keyed(count);
+        bool longer = false;
+        for (size_t i = 0; i < count; ++i) {
+            std::string_view name = keyOf(entries[i].id);
+            keyed[i] = {headOf(name.size() > depth * 8 ? name.substr(depth * 8) : std::string_view()), entries[i]};
+            longer = longer || name.size() > (depth + 1) * 8;
+        }
+        if (!longer) {
+            // The names end within these bytes: compare them whole
+            std::sort(entries, entries + count, [&](const Entry& a, const Entry& b) { return less(a, b, keyOf); });
+            return;
+        }
+        std::sort(keyed.begin(), keyed.end(), [](const Keyed& a, const Keyed& b) { return a.next < b.next; });
+        for (size_t i = 0; i < count; ++i) entries[i] = keyed[i].entry;
+        forEachTie(keyed.data(), count, [](const Keyed& k) { return k.next; }, [&](Keyed* tie, size_t n) {
+            sortTie(entries + (tie - keyed.data()), n, depth + 1, keyOf);
+        });
+    }
+
+    static uint64_t headOf(std::string_view key) {
+        uint64_t head = 0;
+        for (size_t i = 0; i < sizeof(head); ++i) {
+            unsigned char c = i < key.size() ? static_cast<unsigned char>(foldChar(key[i])) : 0;
+            head = (head << 8) | c;
+        }
+        return head;
+    }
+
+    // First block whose last entry is not below entry; the last block if none
+    template <typename KeyOf>
+    size_t blockFor(const Entry& entry, KeyOf& keyOf) const {
+        size_t b = std::partition_point(blocks_.begin(), blocks_.end(), [&](const std::vector<Entry>& block) {
+            return !block.empty() && less(block.back(), entry, keyOf);
+        }) - blocks_.begin();
+        return std::min(b, blocks_.size() - 1);
+    }
+
+    std::vector<std::vector<Entry>> blocks_;
+};
+
+class FuzzyIndex {
+public:
+    // Queries may ask for at most maxDistance edits per word
+    explicit FuzzyIndex(int maxDistance = 2) : maxDistance_(maxDistance) {}
+
+    void clear() {
+        terms_.clear();
+        termIds_.clear();
+        deletions_.clear();
+    }
+
+    void insert(uint32_t id, std::string_view name) {
+        std::vector<uint32_t> terms;
+        forEachWord(name, [&](const std::string& word) { terms.push_back(termFor(word)); });
+        std::sort(terms.begin(), terms.end());
+        terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+        for (size_t i = 0; i < terms.size(); ++i) {
+            Posting posting{id, {kNoTerm, kNoTerm}};
+            if (terms.size() > 3) {
+                posting.others[0] = kSeeName;
+            } else {
+                size_t n = 0;
+                for (size_t j = 0; j < terms.size(); ++j) {
+                    if (j != i) posting.others[n++] = terms[j];
+                }
+            }
+            terms_[terms[i]].postings.push_back(posting);
+        }
+    }
+
+    void erase(uint32_t id, std::string_view name) {
+        forEachWord(name, [&](const std::string& word) {
+            auto term = termIds_.find(word);
+            if (term == termIds_.end()) return;
+            std::vector<Posting>& postings = terms_[term->second].postings;
+            auto it = std::find_if(postings.begin(), postings.end(), [id](const Posting& p) { return p.id == id; });
+            if (it != postings.end()) {
+                *it = postings.back();
+                postings.pop_back();
+            }
+            // The word stays indexed with no postings; a later record may reuse it
+        });
+    }
+
+    // Up to limit (id, distance) pairs, closest first. Every word of the query
+    // must be close to some word of the name (keyOf(id)): within maxDistance
+    // edits, but at most 1 for words of 3 to 5 letters and none for shorter
+    // ones, where more edits match almost anything. The distance is the sum
+    // over the query words.
+    template <typename KeyOf>
+    std::vector<std::pair<uint32_t, int>> find(std::string_view query, int maxDistance, size_t limit, KeyOf keyOf) const {
+        std::vector<std::pair<uint32_t, int>> results;
+        std::vector<std::string> queryWords;
+        forEachWord(query, [&](const std::string& word) { queryWords.push_back(word); });
+        maxDistance = std::min(maxDistance, maxDistance_);
+        if (queryWords.empty() || limit == 0 || maxDistance < 0) return results;
+
+        // Terms close to each query word. The candidates come from the word
+        // with the fewest records; the others are checked through their maps.
+        std::vector<int> allowed;
+        std::vector<TermDistances> close(queryWords.size());
+        size_t pivot = 0;
+        size_t fewest = SIZE_MAX;
+        for (size_t q = 0; q < queryWords.size(); ++q) {
+            allowed.push_back(std::min(maxDistance, queryWords[q].size() < 3 ? 0 : queryWords[q].size() < 6 ? 1 : 2));
+            close[q].assign(matchingTerms(queryWords[q], allowed[q]));
+            size_t records = 0;
+            for (const auto& match : close[q].matches) records += terms_[match.first].postings.size();
+            if (records < fewest) {
+                fewest = records;
+                pivot = q;
+            }
+        }
+        std::vector<std::pair<uint32_t, int>> pivotTerms = close[pivot].matches;
+        std::sort(pivotTerms.begin(), pivotTerms.end(),
+                  [](const std::pair<uint32_t, int>& a, const std::pair<uint32_t, int>& b) { return a.second < b.second; });
+
+        // A name with two words close to the pivot word is listed twice;
+        // only its first, closest, appearance counts
+        size_t capacity = 16;
+        while (capacity < fewest * 2) capacity *= 2;
+        std::vector<uint32_t> seen(capacity, kNoTerm);
+        auto firstVisit = [&](uint32_t id) {
+            size_t i = (id * 0x9E3779B1u) & (capacity - 1);
+            while (seen[i] != kNoTerm) {
+                if (seen[i] == id) return false;
+                i = (i + 1) & (capacity - 1);
+            }
+            seen[i] = id;
+            return true;
+        };
+
+        // Max-heap of the best results so far
+        auto closer = [](const std::pair<uint32_t, int>& a, const std::pair<uint32_t, int>& b) {
+            return a.second != b.second ? a.second < b.second : a.first < b.first;
+        };
+        for (const auto& term : pivotTerms) {
+            // Terms come closest first, so later records can only score worse
+            if (results.size() == limit && term.second >= results.front().second) break;
+            for (const Posting& posting : terms_[term.first].postings) {
+                if (!firstVisit(posting.id)) continue;
+                int score = term.second;
+                for (size_t q = 0; q < queryWords.size() && score >= 0; ++q) {
+                    if (q == pivot) continue;
+                    int best;
+                    if (posting.others[0] == kSeeName) {
+                        best = closestWord(queryWords[q], keyOf(posting.id), allowed[q]);
+                    } else {
+                        best = std::min({close[q].distance(term.first, allowed[q]),
+                                         close[q].distance(posting.others[0], allowed[q]),
+                                         close[q].distance(posting.others[1], allowed[q])});
+                    }
+                    score = best <= allowed[q] ? score + best : -1;
+                }
+                if (score < 0) continue;
+
+                std::pair<uint32_t, int> result{posting.id, score};
+                if (results.size() < limit) {
+                    results.push_back(result);
+                    std::push_heap(results.begin(), results.end(), closer);
+                } else if (closer(result, results.front())) {
+                    std::pop_heap(results.begin(), results.end(), closer);
+                    results.back() = result;
+                    std::push_heap(results.begin(), results.end(), closer);
+                }
+            }
+        }
+        std::sort_heap(results.begin(), results.end(), closer);
+        return results;
+    }
+
+private:
+    static constexpr size_t kMaxWord = 64; // Longer words are cut for distance purposes
+    static constexpr uint32_t kNoTerm = 0xffffffffu;
+    static constexpr uint32_t kSeeName = 0xfffffffeu;
+
+    // A record containing a term, with the record's other words so that
+    // multi-word queries can be checked without reading the record
+    struct Posting {
+        uint32_t id;
+        uint32_t others[2]; // kNoTerm if fewer; others[0] is kSeeName if it has more than three words
+    };
+
+    struct Term {
+        std::string text;
+        std::vector<Posting> postings;
+    };
+
+    // Small open-addressing map from term to its distance to one query word
+    struct TermDistances {
+        std::vector<std::pair<uint32_t, int>> matches;
+        std::vector<std::pair<uint32_t, int>> table;
+        size_t mask = 0;
+
+        void assign(std::vector<std::pair<uint32_t, int>> found) {
+            matches = std::move(found);
+            size_t capacity = 16;
+            while (capacity < matches.size() * 2) capacity *= 2;
+            table.assign(capacity, {kNoTerm, 0});
+            mask = capacity - 1;
+            for (const auto& match : matches) {
+                size_t i = (match.first * 0x9E3779B1u) & mask;
+                while (table[i].first != kNoTerm) i = (i + 1) & mask;
+                table[i] = match;
+            }
+        }
+
+        // Distance of term, or limit + 1 if it is not close
+        int distance(uint32_t term, int limit) const {
+            if (term >= kSeeName) return limit + 1;
+            for (size_t i = (term * 0x9E3779B1u) & mask; table[i].first != kNoTerm; i = (i + 1) & mask) {
+                if (table[i].first == term) return table[i].second;
+            }
+            return limit + 1;
+        }
+    };
+
+    // Call visit(word) for each lowercase alphanumeric word of text
+    template <typename Visit>
+    static void forEachWord(std::string_view text, Visit visit) {
+        std::string word;
+        for (char c : text) {
+            if (isWordChar(c)) {
+                word.push_back(foldChar(c));
+            } else if (!word.empty()) {
+                visit(word);
+                word.clear();
+            }
+        }
+        if (!word.empty()) visit(word);
+    }
+
+    // Levenshtein distance, or limit + 1 as soon as it is known to exceed limit
+    static int editDistance(std::string_view a, std::string_view b, int limit) {
+        if (std::abs(static_cast<int>(a.size()) - static_cast<int>(b.size())) > limit) return limit + 1;
+        int row[kMaxWord + 1];
+        if (b.size() > kMaxWord) b = b.substr(0, kMaxWord);
+        for (size_t j = 0; j <= b.size(); ++j) row[j] = static_cast<int>(j);
+        for (size_t i = 1; i <= a.size(); ++i) {
+            int diagonal = row[0];
+            row[0] = static_cast<int>(i);
+            int rowMin = row[0];
+            for (size_t j = 1; j <= b.size(); ++j) {
+                int above = row[j];
+                row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] != b[j - 1])});
+                diagonal = above;
+                rowMin = std::min(rowMin, row[j]);
+            }
+            if (rowMin > limit) return limit + 1;
+        }
+        return std::min(row[b.size()], limit + 1);
+    }
+
+    // Smallest edit distance from word to a word of name; above maxDistance if none is close
+    static int closestWord(std::string_view word, std::string_view name, int maxDistance) {
+        int best = maxDistance + 1;
+        char folded[kMaxWord];
+        size_t length = 0;
+        for (size_t i = 0; i <= name.size() && best > 0; ++i) {
+            if (i < name.size() && isWordChar(name[i])) {
+                if (length < kMaxWord) folded[length++] = foldChar(name[i]);
+            } else if (length > 0) {
+                best = std::min(best, editDistance(word, std::string_view(folded, length), best - 1));
+                length = 0;
+            }
+        }
+        return best;
+    }
+
+    static uint32_t hashWord(std::string_view word) {
+        uint64_t h = std::hash<std::string_view>()(word);
+        return static_cast<uint32_t>(h ^ (h >> 32));
+    }
+
+    // Hashes of word and of every string made from it by deleting up to depth letters
+    static void addDeletions(const char* word, size_t length, int depth, std::vector<uint32_t>& out) {
+        out.push_back(hashWord(std::string_view(word, length)));
+        if (depth == 0 || length == 0) return;
+        char shorter[kMaxWord];
+        for (size_t i = 0; i < length; ++i) {
+            if (i > 0 && word[i] == word[i - 1]) continue; // Same result as deleting word[i - 1]
+            std::memcpy(shorter, word, i);
+            std::memcpy(shorter + i, word + i + 1, length - i - 1);
+            addDeletions(shorter, length - 1, depth - 1, out);
+        }
+    }
+
+    static std::vector<uint32_t> deletionsOf(std::string_view word, int depth) {
+        std::vector<uint32_t> out;
+        addDeletions(word.data(), std::min(word.size(), kMaxWord), depth, out);
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+        return out;
+    }
+
+    // Hash of a deletion -> terms having it, kept as chains through one pool
+    // of links rather than a vector per deletion. Terms are never removed.
+    struct DeletionTable {
+        struct Slot {
+            uint32_t hash;
+            uint32_t head; // Latest link, kNoTerm for an empty slot
+        };
+        struct Link {
+            uint32_t term;
+            uint32_t next;
+        };
+
+        std::vector<Slot> slots;
+        std::vector<Link> links;
+        size_t used = 0;
+
+        void clear() {
+            slots.clear();
+            links.clear();
+            used = 0;
+        }
+
+        void add(uint32_t hash, uint32_t term) {
+            if ((used + 1) * 2 > slots.size()) grow();
+            Slot& slot = slotFor(slots, hash);
+            if (slot.head == kNoTerm) {
+                slot.hash = hash;
+                ++used;
+            }
+            links.push_back({term, slot.head});
+            slot.head = static_cast<uint32_t>(links.size() - 1);
+        }
+
+        template <typename Visit>
+        void find(uint32_t hash, Visit visit) const {
+            if (slots.empty()) return;
+            size_t mask = slots.size() - 1;
+            for (size_t i = hash & mask; slots[i].head != kNoTerm; i = (i + 1) & mask) {
+                if (slots[i].hash != hash) continue;
+                for (uint32_t link = slots[i].head; link != kNoTerm; link = links[link].next) {
+                    visit(links[link].term);
+                }
+                return;
+            }
+        }
+
+        static Slot& slotFor(std::vector<Slot>& table, uint32_t hash) {
+            size_t mask = table.size() - 1;
+            size_t i = hash & mask;
+            while (table[i].head != kNoTerm && table[i].hash != hash) i = (i + 1) & mask;
+            return table[i];
+        }
+
+        void grow() {
+            std::vector<Slot> larger(slots.empty() ? 1024 : slots.size() * 2, Slot{0, kNoTerm});
+            for (const Slot& slot : slots) {
+                if (slot.head != kNoTerm) slotFor(larger, slot.hash) = slot;
+            }
+            slots.swap(larger);
+        }
+    };
+
+    // Index of word's term, indexing its deletions if it is new
+    uint32_t termFor(const std::string& word) {
+        auto found = termIds_.find(word);
+        if (found != termIds_.end()) return found->second;
+
+        uint32_t id = static_cast<uint32_t>(terms_.size());
+        terms_.push_back({word, {}});
+        termIds_.emplace(word, id);
+        for (uint32_t deletion : deletionsOf(word, maxDistance_)) {
+            deletions_.add(deletion, id);
+        }
+        return id;
+    }
+
+    // (term, distance) for every term with records within maxDistance of word
+    std::vector<std::pair<uint32_t, int>> matchingTerms(const std::string& word, int maxDistance) const {
+        std::vector<std::pair<uint32_t, int>> matches;
+        for (uint32_t deletion : deletionsOf(word, maxDistance)) {
+            deletions_.find(deletion, [&](uint32_t term) {
+                if (terms_[term].postings.empty()) return;
+                int distance = editDistance(word, terms_[term].text, maxDistance);
+                if (distance <= maxDistance) matches.push_back({term, distance});
+            });
+        }
+        // A term sharing several deletions with word was found several times
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+        return matches;
+    }
+
+    int maxDistance_;
+    std::vector<Term> terms_;
+    std::unordered_map<std::string, uint32_t> termIds_;
+    DeletionTable deletions_; // Hash collisions are weeded out by editDistance
+};
+
+#endif // SEARCH_INDEX_H
@@ -0,0 +1,160 @@
+#ifndef STRING_COLUMN_H
+#define STRING_COLUMN_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// One string per row, packed into a single character arena.
+//
+// Each row is an 8-byte reference. A string of up to 7 bytes is stored in
+// the reference itself; a longer one as a 32-bit arena offset and a 31-bit
+// length, with the bytes back to back in the arena. There is no per-string
+// allocation, header or padding, so a column of short strings costs little
+// more than its characters, and a scan walks two flat arrays. The offsets
+// limit the arena to 4 GiB: push() and set() refuse a string that would not
+// fit rather than store a reference that wraps around.
+//
+// Replacing or releasing a row leaves its old bytes behind as garbage; the
+// arena is compacted once the garbage outgrows the live bytes. Views returned
+// by get() stay valid until the column is next modified.
+//
+// The references and the arena can be written out as they are and read back
+// in place (see BookFile.h).
+class StringColumn {
+public:
+    struct Ref {
+        char text[7]; // The string if inline, else offset (4 bytes) and low length bits (3 bytes)
+        uint8_t tag;  // kInline | size if inline, else the high 7 length bits
+    };
+
+    // The string ref points to, given the arena it was stored in
+    static std::string_view view(const Ref& ref, const char* arena) {
+        if (ref.tag & kInline) return std::string_view(ref.text, ref.tag & kInlineSize);
+        return std::string_view(arena + offsetOf(ref), lengthOf(ref));
+    }
+
+    size_t size() const { return refs_.size(); }
+
+    std::string_view get(size_t row) const { return view(refs_[row], arena_.data()); }
+
+    const Ref* refs() const { return refs_.data(); }
+    const char* arena() const { return arena_.data(); }
+    size_t arenaSize() const { return arena_.size(); }
+
+    // False if value can be stored (see fits())
+    bool fits(std::string_view value) const {
+        return value.size() <= kMaxInline || (value.size() <= kMaxLength && value.size() <= kMaxArena - arena_.size());
+    }
+
+    // False if value does not fit; the row is then added empty, so columns
+    // filled side by side keep their rows in step
+    bool push(std::string_view value) {
+        refs_.emplace_back();
+        if (!fits(value)) return false;
+        store(refs_.back(), value);
+        return true;
+    }
+
+    // False, leaving the row as it was, if value does not fit
+    bool set(size_t row, std::string_view value) {
+        if (!fits(value)) return false;
+        Ref old = refs_[row];
+        store(refs_[row], value); // Before compacting, since value may be in the arena
+        discard(old);
+        return true;
+    }
+
+    // Empty the row and give its bytes back to the arena
+    void release(size_t row) {
+        Ref old = refs_[row];
+        refs_[row] = Ref();
+        discard(old);
+    }
+
+    void clear() {
+        refs_.clear();
+        arena_.clear();
+        garbage_ = 0;
+    }
+
+    void reserve(size_t rows, size_t bytes) {
+        refs_.reserve(rows);
+        arena_.reserve(bytes);
+    }
+
+    // Heap bytes held, including spare capacity
+    size_t memoryUsage() const { return refs_.capacity() * sizeof(Ref) + arena_.capacity(); }
+
+private:
+    static const uint8_t kInline = 0x80;
+    static const uint8_t kInlineSize = 0x7f;
+    static const size_t kMaxInline = 7;
+    static const size_t kMinGarbage = 1 << 16;
+    static const size_t kMaxArena = UINT32_MAX;               // Highest 32-bit offset
+    static const size_t kMaxLength = (size_t(1) << 31) - 1; // Longest 31-bit length
+
+    static uint32_t offsetOf(const Ref& ref) {
+        uint32_t offset;
+        std::memcpy(&offset, ref.text, sizeof(offset));
+        return offset;
+    }
+
+    static uint32_t lengthOf(const Ref& ref) {
+        const unsigned char* low = reinterpret_cast<const unsigned char*>(ref.text + 4);
+        return low[0] | (low[1] << 8) | (low[2] << 16) | (static_cast<uint32_t>(ref.tag) << 24);
+    }
+
+    void store(Ref& ref, std::string_view value) {
+        if (value.size() <= kMaxInline) {
+            if (!value.empty()) std::memcpy(ref.text, value.data(), value.size()); // data() may be null
+            ref.tag = static_cast<uint8_t>(kInline | value.size());
+            return;
+        }
+        // value may point into the arena itself, which growing it can move
+        const char* base = arena_.data();
+        bool inArena = !arena_.empty() && value.data() >= base && value.data() < base + arena_.size();
+
+        uint32_t offset = static_cast<uint32_t>(arena_.size());
+        if (inArena) {
+            size_t from = static_cast<size_t>(value.data() - base);
+            arena_.resize(arena_.size() + value.size());
+            std::memcpy(&arena_[offset], arena_.data() + from, value.size());
+        } else {
+            arena_.insert(arena_.end(), value.begin(), value.end());
+        }
+
+        uint32_t length = static_cast<uint32_t>(value.size());
+        std::memcpy(ref.text, &offset, sizeof(offset));
+        ref.text[4] = static_cast<char>(length & 0xff);
+        ref.text[5] = static_cast<char>((length >> 8) & 0xff);
+        ref.text[6] = static_cast<char>((length >> 16) & 0xff);
+        ref.tag = static_cast<uint8_t>(length >> 24);
+    }
+
+    void discard(const Ref& ref) {
+        if (!(ref.tag & kInline)) garbage_ += lengthOf(ref);
+        if (garbage_ > kMinGarbage && garbage_ > arena_.size() / 2) compact();
+    }
+
+    void compact() {
+        std::vector<char> old;
+        old.swap(arena_);
+        arena_.reserve(old.size() - garbage_);
+        for (Ref& ref : refs_) {
+            if (ref.tag & kInline) continue;
+            uint32_t length = lengthOf(ref);
+            uint32_t offset = static_cast<uint32_t>(arena_.size());
+            arena_.insert(arena_.end(), old.data() + offsetOf(ref), old.data() + offsetOf(ref) + length);
+            std::memcpy(ref.text, &offset, sizeof(offset));
+        }
+        garbage_ = 0;
+    }
+
+    std::vector<Ref> refs_;
+    std::vector<char> arena_;
+    size_t garbage_ = 0; // Arena bytes no row refers to
+};
+
+#endif // STRING_COLUMN_H
@@ -1,79 +1,502 @@
 #include <iostream>
-#include <stack>
 #include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <csignal>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 // FunctionTracer Class
 class FunctionTracer {
 public:
-    // Enter a function and log its name
+    // Frames deeper than this are counted but not recorded
+    static const int kMaxDepth = 256;
+    // Cap on recorded trace events per thread, to bound memory
+    static const size_t kMaxEventsPerThread = 1 << 20;
+    // Threads whose stacks the crash handler can see at once
+    static const int kMaxThreads = 256;
+
+    // Enter a function and log its name.
+    // funcName must stay valid while it is on the stack: a string literal,
+    // __func__, or a name returned by intern().
+    static void enterFunction(const char* funcName) {
+        CallStack& stack = callStack;
+        if (!stack.registered) {
+            registerThread(stack);
+        }
+        if (stack.depth < kMaxDepth) {
+            stack.frames[stack.depth] = funcName;
+            stack.nodes[stack.depth] = 0;
+        }
+        ++stack.depth;
+        if (mode.load(std::memory_order_relaxed) != 0) {
+            enterSlow(stack, funcName);
+        }
+    }
+
+    // Same for names built at runtime; the name is interned once
     static void enterFunction(const std::string& funcName) {
-        callStack.push(funcName);
-        std::cout << "Enter to " << funcName << std::endl;
+        enterFunction(intern(funcName));
     }
 
     // Exit a function and log its name
     static void exitFunction() {
-        if (!callStack.empty()) {
-            std::string funcName = callStack.top();
-            callStack.pop();
-            std::cout << "Exit from " << funcName << std::endl;
+        CallStack& stack = callStack;
+        if (stack.depth == 0) return;
+        --stack.depth;
+        if (mode.load(std::memory_order_relaxed) != 0 ||
+            (stack.depth < kMaxDepth && stack.nodes[stack.depth] != 0)) {
+            exitSlow(stack);
         }
     }
 
-    // Print the current backtrace of function calls
+    // Print the current thread's backtrace of function calls
     static void printBacktrace() {
+        const CallStack& stack = callStack;
         std::cout << "\nBacktrace as follows:" << std::endl;
-        std::stack<std::string> tempStack = callStack;
         int level = 0;
-        while (!tempStack.empty()) {
-            std::cout << level++ << " - " << tempStack.top() << std::endl;
-            tempStack.pop();
+        for (int i = stack.depth - 1; i >= 0; --i) {
+            std::cout << level++ << " - " << frameName(stack, i) << std::endl;
         }
         std::cout << "Backtrace is finished\n" << std::endl;
     }
 
+    // Turn the "Enter to"/"Exit from" messages on or off (on by default)
+    static void setPrinting(bool enabled) {
+        setMode(kPrint, enabled);
+    }
+
+    // Time every traced call and aggregate it into a per-thread call tree.
+    // With recordEvents each call is also kept for the Chrome trace export.
+    static void setProfiling(bool enabled, bool recordEvents = false) {
+        if (enabled) {
+            calibrationTicks = readTicks();
+            calibrationTime = std::chrono::steady_clock::now();
+        }
+        setMode(kProfile, enabled);
+        setMode(kEvents, enabled && recordEvents);
+    }
+
+    // Crash reporting: on SIGSEGV, SIGABRT or SIGINT write every thread's traced
+    // stack to fd (opened up front, e.g. STDERR_FILENO or a report file), then
+    // let the signal take its default action. The handler only calls write().
+    static void installCrashHandler(int fd) {
+        crashFd = fd;
+
+        // Run on a separate stack so a stack overflow can still be reported
+        static char alternateStack[64 * 1024];
+        stack_t ss{};
+        ss.ss_sp = alternateStack;
+        ss.ss_size = sizeof(alternateStack);
+        sigaltstack(&ss, nullptr);
+
+        struct sigaction action{};
+        action.sa_handler = crashHandler;
+        action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+        sigemptyset(&action.sa_mask);
+        for (int sig : {SIGSEGV, SIGABRT, SIGINT}) {
+            sigaction(sig, &action, nullptr);
+        }
+    }
+
+    // Return a stable pointer for name; equal names share one pointer
+    static const char* intern(const std::string& name) {
+        static std::mutex internMutex;
+        static std::unordered_set<std::string> names;
+        std::lock_guard<std::mutex> lock(internMutex);
+        return names.insert(name).first->c_str();
+    }
+
+    // Exports below read every thread's profile; call them once the profiled
+    // threads are idle or finished.
+
+    // Call tree with call counts, inclusive and exclusive time
+    static void printProfile(std::ostream& out = std::cout) {
+        std::lock_guard<std::mutex> lock(profilesMutex);
+        double nsPerTick = nanosecondsPerTick();
+        for (const auto& profile : profiles) {
+            out << "Thread " << profile->threadIndex << ":" << std::endl;
+            printNode(out, *profile, 0, 0, nsPerTick);
+        }
+    }
+
+    // One "a;b;c <exclusive ns>" line per call path, the input format of flamegraph.pl
+    static void writeCollapsedStacks(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(profilesMutex);
+        double nsPerTick = nanosecondsPerTick();
+        std::map<std::string, double> paths; // Merges equal paths across threads
+        for (const auto& profile : profiles) {
+            for (size_t i = 1; i < profile->nodes.size(); ++i) {
+                paths[pathOf(*profile, static_cast<uint32_t>(i))] +=
+                    static_cast<double>(profile->nodes[i].exclusiveTicks) * nsPerTick;
+            }
+        }
+        for (const auto& path : paths) {
+            out << path.first << " " << static_cast<uint64_t>(path.second) << "\n";
+        }
+    }
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto) from the recorded calls
+    static void writeChromeTrace(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(profilesMutex);
+        double usPerTick = nanosecondsPerTick() / 1000.0;
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& profile : profiles) {
+            for (const auto& event : profile->events) {
+                out << (first ? "\n" : ",\n");
+                first = false;
+                out << "{\"name\":\"";
+                writeJsonString(out, event.name);
+                out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << profile->threadIndex
+                    << ",\"ts\":" << static_cast<double>(event.start - calibrationTicks) * usPerTick
+                    << ",\"dur\":" << static_cast<double>(event.end - event.start) * usPerTick << "}";
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    // RAII guard: enters on construction, exits on destruction (also during unwinding)
+    class Scope {
+    public:
+        explicit Scope(const char* funcName) { enterFunction(funcName); }
+        ~Scope() { exitFunction(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
 private:
-    static std::stack<std::string> callStack; // Stack to store function call history
+    enum Mode : unsigned {
+        kPrint = 1,
+        kProfile = 2,
+        kEvents = 4
+    };
+
+    // Aggregated time of one call path
+    struct ProfileNode {
+        const char* name;
+        uint32_t parent;
+        uint32_t firstChild;
+        uint32_t nextSibling;
+        uint64_t calls;
+        uint64_t inclusiveTicks;
+        uint64_t exclusiveTicks;
+    };
+
+    struct TraceEvent {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    // Call tree of one thread; node 0 is the root. Kept after the thread exits.
+    struct ThreadProfile {
+        int threadIndex;
+        std::vector<ProfileNode> nodes;
+        std::vector<TraceEvent> events;
+    };
+
+    // Plain data so the thread_local needs no constructor or guard on access
+    struct CallStack {
+        const char* frames[kMaxDepth];
+        uint32_t nodes[kMaxDepth];       // Profile node of each frame, 0 if not profiled
+        uint64_t startTicks[kMaxDepth];
+        uint64_t childTicks[kMaxDepth];  // Time spent in profiled callees
+        int depth;
+        ThreadProfile* profile;
+        bool registered; // Visible to the crash handler
+    };
+
+    // Clears the thread's crash-handler slot when the thread exits
+    struct ThreadExitGuard {
+        int slot;
+        ~ThreadExitGuard() {
+            threadStacks[slot].store(nullptr, std::memory_order_release);
+        }
+    };
+
+    static void registerThread(CallStack& stack) {
+        stack.registered = true;
+        for (int i = 0; i < kMaxThreads; ++i) {
+            CallStack* expected = nullptr;
+            if (threadStacks[i].compare_exchange_strong(expected, &stack)) {
+                thread_local ThreadExitGuard guard{i};
+                (void)guard;
+                return;
+            }
+        }
+        // No free slot: this thread is traced but left out of crash reports
+    }
+
+    // ---- Async-signal-safe output: no allocation, no stdio ----
+
+    static void writeRaw(const char* text, size_t length) {
+        while (length > 0) {
+            ssize_t n = ::write(crashFd, text, length);
+            if (n <= 0) return;
+            text += n;
+            length -= static_cast<size_t>(n);
+        }
+    }
+
+    static void writeText(const char* text) {
+        size_t length = 0;
+        while (text[length] != '\0') ++length;
+        writeRaw(text, length);
+    }
+
+    static void writeNumber(long value) {
+        char digits[24];
+        size_t pos = sizeof(digits);
+        bool negative = value < 0;
+        unsigned long v = negative ? 0UL - static_cast<unsigned long>(value) : static_cast<unsigned long>(value);
+        do {
+            digits[--pos] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v != 0);
+        if (negative) digits[--pos] = '-';
+        writeRaw(digits + pos, sizeof(digits) - pos);
+    }
+
+    static void crashHandler(int sig) {
+        static std::atomic<bool> reporting{false};
+        if (!reporting.exchange(true)) {
+            writeText("\nCaught signal ");
+            writeNumber(sig);
+            writeText(", traced stacks:\n");
+            for (int i = 0; i < kMaxThreads; ++i) {
+                const CallStack* stack = threadStacks[i].load(std::memory_order_acquire);
+                if (stack == nullptr) continue;
+                writeText("Thread ");
+                writeNumber(i);
+                writeText(stack == &callStack ? " (crashed)\n" : "\n");
+                int depth = stack->depth;
+                int level = 0;
+                for (int f = (depth < kMaxDepth ? depth : kMaxDepth) - 1; f >= 0; --f) {
+                    writeText("  ");
+                    writeNumber(level++);
+                    writeText(" - ");
+                    writeText(stack->frames[f]);
+                    writeText("\n");
+                }
+            }
+            writeText("Backtrace is finished\n");
+        }
+        // SA_RESETHAND restored the default action; deliver the signal again
+        raise(sig);
+    }
+
+    static uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static double nanosecondsPerTick() {
+        uint64_t ticks = readTicks() - calibrationTicks;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - calibrationTime).count();
+        return ticks ? static_cast<double>(ns) / static_cast<double>(ticks) : 1.0;
+    }
+
+    static void setMode(unsigned bit, bool enabled) {
+        if (enabled) mode.fetch_or(bit, std::memory_order_relaxed);
+        else mode.fetch_and(~bit, std::memory_order_relaxed);
+    }
+
+    static void enterSlow(CallStack& stack, const char* funcName) {
+        unsigned current = mode.load(std::memory_order_relaxed);
+        if (current & kPrint) {
+            std::cout << "Enter to " << funcName << std::endl;
+        }
+        int index = stack.depth - 1;
+        if (!(current & kProfile) || index >= kMaxDepth) return;
+
+        ThreadProfile& profile = threadProfile(stack);
+        uint32_t parent = index > 0 ? stack.nodes[index - 1] : 0;
+        stack.nodes[index] = childNode(profile, parent, funcName);
+        stack.childTicks[index] = 0;
+        stack.startTicks[index] = readTicks();
+    }
+
+    static void exitSlow(CallStack& stack) {
+        int index = stack.depth;
+        if (index < kMaxDepth && stack.nodes[index] != 0) {
+            uint64_t end = readTicks();
+            uint64_t elapsed = end - stack.startTicks[index];
+            ProfileNode& node = stack.profile->nodes[stack.nodes[index]];
+            ++node.calls;
+            node.inclusiveTicks += elapsed;
+            node.exclusiveTicks += elapsed - stack.childTicks[index];
+            if (index > 0) {
+                stack.childTicks[index - 1] += elapsed;
+            }
+            if ((mode.load(std::memory_order_relaxed) & kEvents) &&
+                stack.profile->events.size() < kMaxEventsPerThread) {
+                stack.profile->events.push_back({node.name, stack.startTicks[index], end});
+            }
+            stack.nodes[index] = 0;
+        }
+        if (mode.load(std::memory_order_relaxed) & kPrint) {
+            std::cout << "Exit from " << frameName(stack, index) << std::endl;
+        }
+    }
+
+    static ThreadProfile& threadProfile(CallStack& stack) {
+        if (stack.profile == nullptr) {
+            std::unique_ptr<ThreadProfile> profile(new ThreadProfile());
+            profile->nodes.push_back({"<root>", 0, 0, 0, 0, 0, 0});
+            stack.profile = profile.get();
+            std::lock_guard<std::mutex> lock(profilesMutex);
+            profile->threadIndex = static_cast<int>(profiles.size());
+            profiles.push_back(std::move(profile));
+        }
+        return *stack.profile;
+    }
+
+    // Find or create the child of parent called name (names are compared by pointer)
+    static uint32_t childNode(ThreadProfile& profile, uint32_t parent, const char* name) {
+        uint32_t child = profile.nodes[parent].firstChild;
+        while (child != 0) {
+            if (profile.nodes[child].name == name) return child;
+            child = profile.nodes[child].nextSibling;
+        }
+        uint32_t index = static_cast<uint32_t>(profile.nodes.size());
+        profile.nodes.push_back({name, parent, 0, profile.nodes[parent].firstChild, 0, 0, 0});
+        profile.nodes[parent].firstChild = index;
+        return index;
+    }
+
+    static std::string pathOf(const ThreadProfile& profile, uint32_t index) {
+        std::string path = profile.nodes[index].name;
+        for (uint32_t p = profile.nodes[index].parent; p != 0; p = profile.nodes[p].parent) {
+            path = std::string(profile.nodes[p].name) + ";" + path;
+        }
+        return path;
+    }
+
+    static void printNode(std::ostream& out, const ThreadProfile& profile, uint32_t index, int indent,
+                          double nsPerTick) {
+        for (uint32_t child = profile.nodes[index].firstChild; child != 0;
+             child = profile.nodes[child].nextSibling) {
+            const ProfileNode& node = profile.nodes[child];
+            out << std::string(static_cast<size_t>(indent) * 2 + 2, ' ') << node.name
+                << "  calls=" << node.calls
+                << "  inclusive=" << static_cast<double>(node.inclusiveTicks) * nsPerTick / 1e6 << " ms"
+                << "  exclusive=" << static_cast<double>(node.exclusiveTicks) * nsPerTick / 1e6 << " ms"
+                << std::endl;
+            printNode(out, profile, child, indent + 1, nsPerTick);
+        }
+    }
+
+    static void writeJsonString(std::ostream& out, const char* text) {
+        for (const char* p = text; *p != '\0'; ++p) {
+            if (*p == '"' || *p == '\\') out << '\\';
+            if (static_cast<unsigned char>(*p) < 0x20) continue;
+            out << *p;
+        }
+    }
+
+    static const char* frameName(const CallStack& stack, int index) {
+        return index < kMaxDepth ? stack.frames[index] : "<frame beyond trace depth>";
+    }
+
+    static thread_local CallStack callStack; // Stack to store function call history, one per thread
+    static std::atomic<unsigned> mode;       // Mode bits; 0 keeps enter/exit on the fast path
+    static std::atomic<CallStack*> threadStacks[kMaxThreads];
+    static int crashFd;
+
+    static std::mutex profilesMutex;
+    static std::vector<std::unique_ptr<ThreadProfile>> profiles;
+    static uint64_t calibrationTicks;
+    static std::chrono::steady_clock::time_point calibrationTime;
 };
 
-// Initialize the static call stack
-std::stack<std::string> FunctionTracer::callStack;
+// Initialize the static members
+thread_local FunctionTracer::CallStack FunctionTracer::callStack;
+std::atomic<unsigned> FunctionTracer::mode{FunctionTracer::kPrint};
+std::atomic<FunctionTracer::CallStack*> FunctionTracer::threadStacks[FunctionTracer::kMaxThreads];
+int FunctionTracer::crashFd = STDERR_FILENO;
+std::mutex FunctionTracer::profilesMutex;
+std::vector<std::unique_ptr<FunctionTracer::ThreadProfile>> FunctionTracer::profiles;
+uint64_t FunctionTracer::calibrationTicks = 0;
+std::chrono::steady_clock::time_point FunctionTracer::calibrationTime;
+
+// Trace the enclosing function for the rest of its scope
+#define TRACE_FUNCTION() FunctionTracer::Scope traceScope_(__func__)
 
 // Functions with tracing
 void func3() {
-    FunctionTracer::enterFunction("func3");
+    TRACE_FUNCTION();
     try {
         // Function logic (add your code here)
     } catch (...) {
         FunctionTracer::printBacktrace();
         throw;
     }
-    FunctionTracer::exitFunction();
 }
 
 void func2() {
-    FunctionTracer::enterFunction("func2");
+    TRACE_FUNCTION();
     try {
         func3();
     } catch (...) {
         FunctionTracer::printBacktrace();
         throw;
     }
-    FunctionTracer::exitFunction();
 }
 
 void func1() {
-    FunctionTracer::enterFunction("func1");
+    TRACE_FUNCTION();
     try {
         func2();
     } catch (...) {
         FunctionTracer::printBacktrace();
         throw;
     }
-    FunctionTracer::exitFunction();
 }
 
-int main() {
+// Some work worth profiling
+volatile double sink;
+
+void computeStep() {
+    TRACE_FUNCTION();
+    double sum = 0;
+    for (int i = 0; i < 20000; ++i) sum += i * 0.5;
+    sink = sum;
+}
+
+// With --crash the last batch dies in here to show the crash report
+bool crashRequested = false;
+
+void crashingStep() {
+    TRACE_FUNCTION();
+    raise(SIGSEGV);
+}
+
+void processBatch(bool last) {
+    TRACE_FUNCTION();
+    for (int i = 0; i < 10; ++i) computeStep();
+    func1();
+    if (last && crashRequested) crashingStep();
+}
+
+int main(int argc, char* argv[]) {
+    crashRequested = argc > 1 && std::string(argv[1]) == "--crash";
+
     FunctionTracer::enterFunction("main");
     try {
         func1();
@@ -83,5 +506,36 @@ int main() {
     }
     FunctionTracer::exitFunction();
 
+    // Without printing, tracing is cheap enough for hot paths
+    FunctionTracer::setPrinting(false);
+    const int iterations = 10000000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        FunctionTracer::Scope scope("hot_path");
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Enter/exit pair: "
+              << static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations
+              << " ns" << std::endl;
+
+    // Profile a workload and export it. A crash or Ctrl+C during it prints
+    // the traced stacks to stderr.
+    FunctionTracer::installCrashHandler(STDERR_FILENO);
+    FunctionTracer::setProfiling(true, true);
+    {
+        FunctionTracer::Scope scope("main");
+        for (int i = 0; i < 5; ++i) processBatch(i == 4);
+    }
+    FunctionTracer::setProfiling(false);
+
+    std::cout << "\nProfile:" << std::endl;
+    FunctionTracer::printProfile();
+
+    std::ofstream collapsed("profile.folded");
+    FunctionTracer::writeCollapsedStacks(collapsed); // flamegraph.pl profile.folded > flame.svg
+    std::ofstream trace("trace.json");
+    FunctionTracer::writeChromeTrace(trace);         // Open in chrome://tracing or Perfetto
+    std::cout << "Wrote profile.folded and trace.json" << std::endl;
+
     return 0;
 }
@@ -0,0 +1,421 @@
+#ifndef STRING_KERNELS_H
+#define STRING_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STRING_KERNELS_X86_SIMD 1
+#endif
+
+// Byte-string search, comparison, ASCII case conversion and character class
+// counts, in scalar, SSE2 and AVX2 versions.
+//
+// The fastest version the CPU supports is picked once, on first use, and
+// called through a table of function pointers. Each vector loop works on
+// whole 16 or 32-byte blocks with unaligned loads that never read past the
+// end of the text, and finishes the last partial block with the scalar code.
+// Only ASCII letters count as letters; other bytes are left as they are.
+// "Not found" is the size of the text, as with findByte() in the UART code.
+// 07_OOP2_2/tasks has the same header; keep fixes to the two in step.
+
+struct CharCounts {
+    size_t vowels; // a e i o u, either case
+    size_t digits;
+    size_t alpha;
+};
+
+struct StringKernels {
+    const char* name;
+    // First position of needle in text, 0 for an empty needle
+    size_t (*find)(const char* text, size_t size, const char* needle, size_t needleSize);
+    // First position of a byte from set
+    size_t (*findFirstOf)(const char* text, size_t size, const char* set, size_t setSize);
+    // Negative, zero or positive as a sorts before, with or after b, bytewise
+    // unsigned, a prefix first
+    int (*compare)(const char* a, size_t aSize, const char* b, size_t bSize);
+    void (*toLower)(char* text, size_t size);
+    void (*toUpper)(char* text, size_t size);
+    CharCounts (*countClasses)(const char* text, size_t size);
+};
+
+namespace stringkernels {
+
+// Sets larger than this go through a 256-entry table instead of one vector
+// compare per member
+const size_t kMaxVectorSet = 16;
+
+inline bool isVowel(unsigned char c) {
+    c |= 0x20;
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+}
+
+inline bool isDigit(unsigned char c) { return static_cast<unsigned char>(c - '0') < 10; }
+inline bool isAlpha(unsigned char c) { return static_cast<unsigned char>((c | 0x20) - 'a') < 26; }
+
+// Scalar versions, which also finish the vector ones from position from
+
+inline size_t findFrom(const char* text, size_t size, const char* needle, size_t needleSize, size_t from) {
+    if (needleSize == 0) return 0;
+    if (needleSize > size) return size;
+    size_t end = size - needleSize + 1; // Past the last possible start
+    while (from < end) {
+        const void* p = std::memchr(text + from, needle[0], end - from);
+        if (!p) break;
+        size_t at = static_cast<size_t>(static_cast<const char*>(p) - text);
+        if (std::memcmp(text + at + 1, needle + 1, needleSize - 1) == 0) return at;
+        from = at + 1;
+    }
+    return size;
+}
+
+inline size_t findScalar(const char* text, size_t size, const char* needle, size_t needleSize) {
+    return findFrom(text, size, needle, needleSize, 0);
+}
+
+inline size_t findFirstOfFrom(const char* text, size_t size, const char* set, size_t setSize, size_t from) {
+    for (size_t i = from; i < size; ++i) {
+        if (std::memchr(set, text[i], setSize)) return i;
+    }
+    return size;
+}
+
+inline size_t findFirstOfScalar(const char* text, size_t size, const char* set, size_t setSize) {
+    if (setSize <= 4) return findFirstOfFrom(text, size, set, setSize, 0);
+    bool inSet[256] = {};
+    for (size_t k = 0; k < setSize; ++k) inSet[static_cast<unsigned char>(set[k])] = true;
+    for (size_t i = 0; i < size; ++i) {
+        if (inSet[static_cast<unsigned char>(text[i])]) return i;
+    }
+    return size;
+}
+
+inline int compareFrom(const char* a, size_t aSize, const char* b, size_t bSize, size_t from) {
+    size_t common = aSize < bSize ? aSize : bSize;
+    int order = common > from ? std::memcmp(a + from, b + from, common - from) : 0;
+    if (order != 0) return order < 0 ? -1 : 1;
+    return aSize < bSize ? -1 : aSize > bSize ? 1 : 0;
+}
+
+inline int compareScalar(const char* a, size_t aSize, const char* b, size_t bSize) {
+    return compareFrom(a, aSize, b, bSize, 0);
+}
+
+// Flip bit 0x20 of the letters from first to first + 25
+inline void flipCaseFrom(char* text, size_t size, char first, size_t from) {
+    for (size_t i = from; i < size; ++i) {
+        if (static_cast<unsigned char>(text[i] - first) < 26) text[i] ^= 0x20;
+    }
+}
+
+inline void toLowerScalar(char* text, size_t size) { flipCaseFrom(text, size, 'A', 0); }
+inline void toUpperScalar(char* text, size_t size) { flipCaseFrom(text, size, 'a', 0); }
+
+inline void countClassesFrom(const char* text, size_t size, size_t from, CharCounts& counts) {
+    for (size_t i = from; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        counts.vowels += isVowel(c);
+        counts.digits += isDigit(c);
+        counts.alpha += isAlpha(c);
+    }
+}
+
+inline CharCounts countClassesScalar(const char* text, size_t size) {
+    CharCounts counts = {0, 0, 0};
+    countClassesFrom(text, size, 0, counts);
+    return counts;
+}
+
+#ifdef STRING_KERNELS_X86_SIMD
+
+// Range tests compare signed: x + (0x80 - first) lands in [-128, -128 + n)
+// exactly when x is in [first, first + n)
+
+__attribute__((target("sse2")))
+inline __m128i inRangeSse2(__m128i v, char first, int n) {
+    __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - first)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + n)));
+}
+
+__attribute__((target("sse2")))
+inline size_t findSse2(const char* text, size_t size, const char* needle, size_t needleSize) {
+    if (needleSize == 0) return 0;
+    if (needleSize > size) return size;
+    // Candidates match the first and the last byte of needle; only those
+    // are compared in full
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needleSize - 1]);
+    size_t end = size - needleSize + 1;
+    size_t i = 0;
+    for (; i + 16 <= end; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + needleSize - 1));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        while (mask != 0) {
+            size_t at = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (needleSize <= 2 || std::memcmp(text + at + 1, needle + 1, needleSize - 2) == 0) return at;
+            mask &= mask - 1;
+        }
+    }
+    return findFrom(text, size, needle, needleSize, i);
+}
+
+__attribute__((target("sse2")))
+inline size_t findFirstOfSse2(const char* text, size_t size, const char* set, size_t setSize) {
+    if (setSize > kMaxVectorSet) return findFirstOfScalar(text, size, set, setSize);
+    if (setSize == 0) return size;
+    __m128i members[kMaxVectorSet];
+    for (size_t k = 0; k < setSize; ++k) members[k] = _mm_set1_epi8(set[k]);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        __m128i hit = _mm_cmpeq_epi8(v, members[0]);
+        for (size_t k = 1; k < setSize; ++k) hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, members[k]));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask != 0) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+    return findFirstOfFrom(text, size, set, setSize, i);
+}
+
+__attribute__((target("sse2")))
+inline int compareSse2(const char* a, size_t aSize, const char* b, size_t bSize) {
+    size_t common = aSize < bSize ? aSize : bSize;
+    size_t i = 0;
+    for (; i + 16 <= common; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        unsigned equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+        if (equal != 0xffff) {
+            size_t at = i + static_cast<size_t>(__builtin_ctz(~equal));
+            return static_cast<unsigned char>(a[at]) < static_cast<unsigned char>(b[at]) ? -1 : 1;
+        }
+    }
+    return compareFrom(a, aSize, b, bSize, i);
+}
+
+__attribute__((target("sse2")))
+inline void flipCaseSse2(char* text, size_t size, char first) {
+    const __m128i bit = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        v = _mm_xor_si128(v, _mm_and_si128(inRangeSse2(v, first, 26), bit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(text + i), v);
+    }
+    flipCaseFrom(text, size, first, i);
+}
+
+__attribute__((target("sse2")))
+inline void toLowerSse2(char* text, size_t size) { flipCaseSse2(text, size, 'A'); }
+
+__attribute__((target("sse2")))
+inline void toUpperSse2(char* text, size_t size) { flipCaseSse2(text, size, 'a'); }
+
+// Matches are -1 bytes, so subtracting them counts per byte lane; the lanes
+// are added up with psadbw before they can overflow, every 255 blocks
+__attribute__((target("sse2")))
+inline uint64_t sumLanesSse2(__m128i counts) {
+    uint64_t sums[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), _mm_sad_epu8(counts, _mm_setzero_si128()));
+    return sums[0] + sums[1];
+}
+
+__attribute__((target("sse2")))
+inline CharCounts countClassesSse2(const char* text, size_t size) {
+    CharCounts counts = {0, 0, 0};
+    const __m128i bit = _mm_set1_epi8(0x20);
+    const char vowels[] = {'a', 'e', 'i', 'o', 'u'};
+    size_t i = 0;
+    while (i + 16 <= size) {
+        __m128i vowelCount = _mm_setzero_si128(), digitCount = _mm_setzero_si128(),
+                alphaCount = _mm_setzero_si128();
+        for (int block = 0; block < 255 && i + 16 <= size; ++block, i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            __m128i lower = _mm_or_si128(v, bit);
+            __m128i vowel = _mm_cmpeq_epi8(lower, _mm_set1_epi8(vowels[0]));
+            for (int k = 1; k < 5; ++k) vowel = _mm_or_si128(vowel, _mm_cmpeq_epi8(lower, _mm_set1_epi8(vowels[k])));
+            vowelCount = _mm_sub_epi8(vowelCount, vowel);
+            digitCount = _mm_sub_epi8(digitCount, inRangeSse2(v, '0', 10));
+            alphaCount = _mm_sub_epi8(alphaCount, inRangeSse2(lower, 'a', 26));
+        }
+        counts.vowels += sumLanesSse2(vowelCount);
+        counts.digits += sumLanesSse2(digitCount);
+        counts.alpha += sumLanesSse2(alphaCount);
+    }
+    countClassesFrom(text, size, i, counts);
+    return counts;
+}
+
+__attribute__((target("avx2")))
+inline __m256i inRangeAvx2(__m256i v, char first, int n) {
+    __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(0x80 - first)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + n)), shifted);
+}
+
+__attribute__((target("avx2")))
+inline size_t findAvx2(const char* text, size_t size, const char* needle, size_t needleSize) {
+    if (needleSize == 0) return 0;
+    if (needleSize > size) return size;
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needleSize - 1]);
+    size_t end = size - needleSize + 1;
+    size_t i = 0;
+    for (; i + 32 <= end; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + needleSize - 1));
+        unsigned mask = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        while (mask != 0) {
+            size_t at = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (needleSize <= 2 || std::memcmp(text + at + 1, needle + 1, needleSize - 2) == 0) return at;
+            mask &= mask - 1;
+        }
+    }
+    return findFrom(text, size, needle, needleSize, i);
+}
+
+__attribute__((target("avx2")))
+inline size_t findFirstOfAvx2(const char* text, size_t size, const char* set, size_t setSize) {
+    if (setSize > kMaxVectorSet) return findFirstOfScalar(text, size, set, setSize);
+    if (setSize == 0) return size;
+    __m256i members[kMaxVectorSet];
+    for (size_t k = 0; k < setSize; ++k) members[k] = _mm256_set1_epi8(set[k]);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        __m256i hit = _mm256_cmpeq_epi8(v, members[0]);
+        for (size_t k = 1; k < setSize; ++k) hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, members[k]));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask != 0) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+    return findFirstOfFrom(text, size, set, setSize, i);
+}
+
+__attribute__((target("avx2")))
+inline int compareAvx2(const char* a, size_t aSize, const char* b, size_t bSize) {
+    size_t common = aSize < bSize ? aSize : bSize;
+    size_t i = 0;
+    // Two vectors per iteration, tested together, to keep both load ports busy
+    for (; i + 64 <= common; i += 64) {
+        __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32));
+        __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32));
+        __m256i differ = _mm256_or_si256(_mm256_xor_si256(x0, y0), _mm256_xor_si256(x1, y1));
+        if (!_mm256_testz_si256(differ, differ)) break;
+    }
+    for (; i + 32 <= common; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        unsigned equal = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if (equal != 0xffffffffu) {
+            size_t at = i + static_cast<size_t>(__builtin_ctz(~equal));
+            return static_cast<unsigned char>(a[at]) < static_cast<unsigned char>(b[at]) ? -1 : 1;
+        }
+    }
+    return compareFrom(a, aSize, b, bSize, i);
+}
+
+__attribute__((target("avx2")))
+inline void flipCaseAvx2(char* text, size_t size, char first) {
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        v = _mm256_xor_si256(v, _mm256_and_si256(inRangeAvx2(v, first, 26), bit));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(text + i), v);
+    }
+    flipCaseFrom(text, size, first, i);
+}
+
+__attribute__((target("avx2")))
+inline void toLowerAvx2(char* text, size_t size) { flipCaseAvx2(text, size, 'A'); }
+
+__attribute__((target("avx2")))
+inline void toUpperAvx2(char* text, size_t size) { flipCaseAvx2(text, size, 'a'); }
+
+__attribute__((target("avx2")))
+inline uint64_t sumLanesAvx2(__m256i counts) {
+    uint64_t sums[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums), _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    return sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+__attribute__((target("avx2")))
+inline CharCounts countClassesAvx2(const char* text, size_t size) {
+    CharCounts counts = {0, 0, 0};
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    const char vowels[] = {'a', 'e', 'i', 'o', 'u'};
+    size_t i = 0;
+    while (i + 32 <= size) {
+        __m256i vowelCount = _mm256_setzero_si256(), digitCount = _mm256_setzero_si256(),
+                alphaCount = _mm256_setzero_si256();
+        for (int block = 0; block < 255 && i + 32 <= size; ++block, i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+            __m256i lower = _mm256_or_si256(v, bit);
+            __m256i vowel = _mm256_cmpeq_epi8(lower, _mm256_set1_epi8(vowels[0]));
+            for (int k = 1; k < 5; ++k) {
+                vowel = _mm256_or_si256(vowel, _mm256_cmpeq_epi8(lower, _mm256_set1_epi8(vowels[k])));
+            }
+            vowelCount = _mm256_sub_epi8(vowelCount, vowel);
+            digitCount = _mm256_sub_epi8(digitCount, inRangeAvx2(v, '0', 10));
+            alphaCount = _mm256_sub_epi8(alphaCount, inRangeAvx2(lower, 'a', 26));
+        }
+        counts.vowels += sumLanesAvx2(vowelCount);
+        counts.digits += sumLanesAvx2(digitCount);
+        counts.alpha += sumLanesAvx2(alphaCount);
+    }
+    countClassesFrom(text, size, i, counts);
+    return counts;
+}
+
+#endif // STRING_KERNELS_X86_SIMD
+
+const StringKernels kScalar = {"scalar", findScalar, findFirstOfScalar, compareScalar,
+                               toLowerScalar, toUpperScalar, countClassesScalar};
+#ifdef STRING_KERNELS_X86_SIMD
+const StringKernels kSse2 = {"sse2", findSse2, findFirstOfSse2, compareSse2,
+                             toLowerSse2, toUpperSse2, countClassesSse2};
+const StringKernels kAvx2 = {"avx2", findAvx2, findFirstOfAvx2, compareAvx2,
+                             toLowerAvx2, toUpperAvx2, countClassesAvx2};
+#endif
+
+// The versions this CPU can run, slowest first
+inline std::vector<const StringKernels*> available() {
+    std::vector<const StringKernels*> kernels = {&kScalar};
+#ifdef STRING_KERNELS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) kernels.push_back(&kSse2);
+    if (__builtin_cpu_supports("avx2")) kernels.push_back(&kAvx2);
+#endif
+    return kernels;
+}
+
+inline const StringKernels& best() {
+    static const StringKernels* const kernels = available().back();
+    return *kernels;
+}
+
+inline size_t find(const char* text, size_t size, const char* needle, size_t needleSize) {
+    return best().find(text, size, needle, needleSize);
+}
+
+inline size_t findFirstOf(const char* text, size_t size, const char* set, size_t setSize) {
+    return best().findFirstOf(text, size, set, setSize);
+}
+
+inline int compare(const char* a, size_t aSize, const char* b, size_t bSize) {
+    return best().compare(a, aSize, b, bSize);
+}
+
+inline void toLower(char* text, size_t size) { best().toLower(text, size); }
+inline void toUpper(char* text, size_t size) { best().toUpper(text, size); }
+inline CharCounts countClasses(const char* text, size_t size) { return best().countClasses(text, size); }
+
+} // namespace stringkernels
+
+#endif // STRING_KERNELS_H
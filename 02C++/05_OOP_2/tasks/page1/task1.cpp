@@ -1,20 +1,35 @@
 #include <iostream>
 #include <csignal>
+#include <unistd.h>
+
+// Only async-signal-safe calls are allowed in a handler: no iostream, no exit()
+volatile sig_atomic_t interrupted = 0;
 
 void signalHandler(int signal) {
-    std::cout << "Interrupt signal (" << signal << ") received.\n";
-    // Cleanup and close resources here
-    exit(signal);
+    interrupted = signal;
+    const char message[] = "Interrupt signal received.\n";
+    write(STDOUT_FILENO, message, sizeof(message) - 1);
 }
 
 int main() {
+    // Block SIGINT so it can only arrive inside sigsuspend(): a signal landing
+    // between the flag check and pause() would otherwise be slept through
+    sigset_t blocked, waitMask;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigprocmask(SIG_BLOCK, &blocked, &waitMask);
+    sigdelset(&waitMask, SIGINT);
+
     // Register signal and signal handler
     signal(SIGINT, signalHandler);
 
-    std::cout << "Program running. Press Ctrl+C to interrupt.\n";
-    while (true) {
-        // Infinite loop, simulating a running program
+    std::cout << "Program running. Press Ctrl+C to interrupt." << std::endl;
+    while (!interrupted) {
+        // Loop until interrupted, simulating a running program
+        sigsuspend(&waitMask);
     }
 
-    return 0;
+    // Cleanup and close resources here, outside the handler
+    std::cout << "Interrupt signal (" << interrupted << ") handled, exiting.\n";
+    return interrupted;
 }
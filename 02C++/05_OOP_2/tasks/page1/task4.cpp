@@ -1,24 +1,166 @@
 #include <iostream>
-#include <cstring> // For strlen and strcpy
+#include <atomic>
+#include <cstdint>
+#include <cstring> // For strlen and memcpy
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "StringKernels.h" // SIMD search, compare and case kernels
 
+// The characters of one or more Strings, allocated as a single block: this
+// header, then the text and its '\0'. refs counts the Strings pointing at
+// it; the last one to let go frees it.
+struct StringBuffer {
+    std::atomic<uint32_t> refs;
+    bool interned; // Owned by the intern table, never written
+    std::size_t length;
+
+    char* text() { return reinterpret_cast<char*>(this + 1); }
+    std::string_view view() { return std::string_view(text(), length); }
+
+    static StringBuffer* create(const char* s, std::size_t length, bool interned) {
+        StringBuffer* buffer = static_cast<StringBuffer*>(::operator new(sizeof(StringBuffer) + length + 1));
+        new (buffer) StringBuffer{{1}, interned, length};
+        std::memcpy(buffer->text(), s, length);
+        buffer->text()[length] = '\0';
+        return buffer;
+    }
+
+    static StringBuffer* of(char* text) { return reinterpret_cast<StringBuffer*>(text) - 1; }
+
+    static void destroy(StringBuffer* buffer) {
+        buffer->~StringBuffer();
+        ::operator delete(buffer);
+    }
+};
+
+// Every interned text once, so two interned Strings are equal exactly when
+// they share a buffer.
+//
+// The table is split into shards by hash, each with its own lock, so
+// threads interning different texts rarely wait on each other. A buffer
+// leaves the table when its last String goes. A lookup may still find it
+// between its count reaching zero and its removal: such a buffer is never
+// revived, the lookup puts a fresh buffer in its place instead, so exactly
+// one thread ever frees it.
+class InternTable {
+public:
+    static InternTable& global() {
+        static InternTable table;
+        return table;
+    }
+
+    // The buffer holding text, with a reference for the caller
+    StringBuffer* acquire(std::string_view text) {
+        Shard& shard = shardOf(text);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.buffers.find(text);
+        if (it != shard.buffers.end()) {
+            StringBuffer* buffer = it->second;
+            uint32_t refs = buffer->refs.load(std::memory_order_relaxed);
+            while (refs != 0 &&
+                   !buffer->refs.compare_exchange_weak(refs, refs + 1, std::memory_order_relaxed)) {
+            }
+            if (refs != 0) return buffer;
+            shard.buffers.erase(it); // Dying: its last owner frees it
+        }
+        StringBuffer* buffer = StringBuffer::create(text.data(), text.size(), true);
+        shard.buffers.emplace(buffer->view(), buffer);
+        return buffer;
+    }
+
+    // Called once the last reference to buffer is gone
+    void release(StringBuffer* buffer) {
+        Shard& shard = shardOf(buffer->view());
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.buffers.find(buffer->view());
+            if (it != shard.buffers.end() && it->second == buffer) shard.buffers.erase(it);
+        }
+        StringBuffer::destroy(buffer);
+    }
+
+    // Distinct texts interned right now
+    std::size_t size() {
+        std::size_t count = 0;
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            count += shard.buffers.size();
+        }
+        return count;
+    }
+
+private:
+    static const std::size_t kShards = 64;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string_view, StringBuffer*> buffers; // Keys point into the buffers
+    };
+
+    Shard& shardOf(std::string_view text) {
+        return shards_[std::hash<std::string_view>()(text) % kShards];
+    }
+
+    Shard shards_[kShards];
+};
+
+// Immutable-by-default string: copies share one reference-counted buffer, so
+// copying or assigning costs an atomic increment whatever the length. The
+// few calls that modify the text (toLower, toUpper) first take a private
+// copy if the buffer is shared (copy on write).
+//
+// intern() returns the String for the same text from the global
+// InternTable; comparing two interned Strings is a pointer compare. As with
+// std::shared_ptr, one String must not be used from two threads at once
+// without a lock, but Strings sharing a buffer may be used from any threads.
 class String {
 private:
-    char* str;
+    char* str; // Text of a StringBuffer, or nullptr once moved from
     std::size_t length;
 
+    StringBuffer* buffer() const { return StringBuffer::of(str); }
+
+    void retain() {
+        if (str) buffer()->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() {
+        if (!str) return;
+        StringBuffer* shared = buffer();
+        if (shared->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        if (shared->interned) {
+            InternTable::global().release(shared);
+        } else {
+            StringBuffer::destroy(shared);
+        }
+    }
+
+    explicit String(StringBuffer* owned) : str(owned->text()), length(owned->length) {}
+
+    // Make the buffer ours alone before writing to it
+    void makeUnique() {
+        if (!str) return;
+        StringBuffer* shared = buffer();
+        if (!shared->interned && shared->refs.load(std::memory_order_acquire) == 1) return;
+        StringBuffer* copy = StringBuffer::create(str, length, false);
+        release();
+        str = copy->text();
+    }
+
 public:
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
     // Constructor
-    String(const char* s) {
-        length = std::strlen(s);
-        str = new char[length + 1]; // Allocate memory for the string
-        std::strcpy(str, s); // Copy the string
-    }
+    String(const char* s) : String(StringBuffer::create(s, std::strlen(s), false)) {}
 
-    // Copy constructor
-    String(const String& other) {
-        length = other.length;
-        str = new char[length + 1];
-        std::strcpy(str, other.str);
+    // Copy constructor: shares other's buffer
+    String(const String& other) : str(other.str), length(other.length) {
+        retain();
     }
 
     // Move constructor
@@ -31,9 +173,49 @@ public:
 
     // Destructor
     ~String() {
-        delete[] str;
+        release();
+    }
+
+    String& operator=(const String& other) {
+        String copy(other); // Safe for self-assignment
+        swap(copy);
+        return *this;
+    }
+
+    String& operator=(String&& other) noexcept {
+        String moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    void swap(String& other) noexcept {
+        std::swap(str, other.str);
+        std::swap(length, other.length);
     }
 
+    // The String for s from the global intern table
+    static String intern(const char* s) {
+        return String(InternTable::global().acquire(std::string_view(s, std::strlen(s))));
+    }
+
+    // The interned String equal to this one
+    String intern() const {
+        if (isInterned()) return *this;
+        return String(InternTable::global().acquire(std::string_view(str ? str : "", length)));
+    }
+
+    bool isInterned() const { return str && buffer()->interned; }
+
+    // Strings sharing a buffer are equal without looking at the text, and
+    // interned ones are equal only if they do
+    friend bool operator==(const String& a, const String& b) {
+        if (a.str == b.str) return true;
+        if (a.isInterned() && b.isInterned()) return false;
+        return a.length == b.length && (a.length == 0 || std::memcmp(a.str, b.str, a.length) == 0);
+    }
+
+    friend bool operator!=(const String& a, const String& b) { return !(a == b); }
+
 
     // Get the length of the string
     std::size_t getLength() const {
@@ -45,6 +227,42 @@ public:
         return str;
     }
 
+    // Position of the first s at or after from, or npos
+    std::size_t find(const char* s, std::size_t from = 0) const {
+        std::size_t needle = std::strlen(s);
+        if (from > length) return npos;
+        std::size_t at = stringkernels::find(str + from, length - from, s, needle);
+        return at == length - from && needle != 0 ? npos : from + at;
+    }
+
+    // Position of the first character from set at or after from, or npos
+    std::size_t findFirstOf(const char* set, std::size_t from = 0) const {
+        if (from >= length) return npos;
+        std::size_t at = stringkernels::findFirstOf(str + from, length - from, set, std::strlen(set));
+        return at == length - from ? npos : from + at;
+    }
+
+    // Negative, zero or positive as this string sorts before, equal to or after other
+    int compare(const String& other) const {
+        return stringkernels::compare(str, length, other.str, other.length);
+    }
+
+    // ASCII letters only, in place; copies a shared buffer first
+    void toLower() {
+        makeUnique();
+        stringkernels::toLower(str, length);
+    }
+
+    void toUpper() {
+        makeUnique();
+        stringkernels::toUpper(str, length);
+    }
+
+    // Vowels, digits and letters, counted in one pass
+    CharCounts countClasses() const {
+        return stringkernels::countClasses(str, length);
+    }
+
     // Display the string
     void display() const {
         std::cout << "String: " << str << ", Length: " << length << std::endl;
@@ -55,6 +273,30 @@ int main() {
     String s1("Hello, World!");
     s1.display();
 
+    CharCounts counts = s1.countClasses();
+    std::cout << "\"World\" at " << s1.find("World") << ", first punctuation at " << s1.findFirstOf(",.!?")
+              << ", " << counts.vowels << " vowels, " << counts.alpha << " letters" << std::endl;
+    String s2 = s1; // Shares s1's buffer
+    s2.toUpper();   // Takes its own copy first
+    s1.display();
+    s2.display();
+
+    // Threads interning the same labels at once end up with the same buffers
+    std::vector<String> labels(4, String(""));
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < labels.size(); ++t) {
+        threads.emplace_back([&labels, t] {
+            for (int i = 0; i < 1000; ++i) {
+                String label = String::intern(i % 2 ? "config.timeout" : "config.retries");
+                if (i == 999) labels[t] = label;
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    bool same = labels[0].getString() == labels[3].getString() && labels[0] == labels[1];
+    std::cout << "Interned labels " << (same ? "share" : "do not share") << " one buffer, "
+              << InternTable::global().size() << " texts interned" << std::endl;
+
 
     return 0;
 }
@@ -1,27 +1,133 @@
 #include <iostream>
+#include <fstream>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <glob.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ObjectStore.h"
+#include "WorkStealingPool.h"
+
+// Repository layout under repoDir:
+//   objects.pack  content-addressed blobs (see ObjectStore.h)
+//   commits.log   one record per commit: its message, parent and the tree
+//                 changes against the parent; file contents live in the pack
+//   index         stat cache: mtime, size, inode and blob of every tracked
+//                 path, so status() only re-hashes files whose stat changed.
+//                 Adds only update it in memory; it is written by commit(),
+//                 status() and the destructor.
+//
+// Only HEAD's tree is kept fully in memory. Older trees are rebuilt on demand
+// by replaying deltas, so history costs memory and disk per change, not per
+// file per commit.
+
+const uint32_t kCommitMagic = 0x544d4f43; // "COMT"
+const size_t kMapThreshold = 256 * 1024;   // Files from this size on are mmap()ed
+
+struct CommitRecord {
+    uint32_t magic;
+    int32_t parent;
+    uint32_t messageLength;
+    uint32_t changeCount;
+};
+
+struct ChangeRecord {
+    ObjectId blob;
+    uint32_t pathLength;
+    uint32_t removed;
+};
+
+const char kIndexMagic[8] = {'M', 'G', 'I', 'N', 'D', 'E', 'X', '1'};
+
+struct IndexRecord {
+    ObjectId blob;
+    int64_t mtimeNs;
+    uint64_t size;
+    uint64_t inode;
+    uint32_t pathLength;
+    uint32_t reserved;
+};
 
 class GitManager {
 public:
-    // Constructor
-    GitManager() {
-        std::cout << "Initialized new Git repository." << std::endl;
+    // Constructor; reopens the repository in repoDir if one exists
+    explicit GitManager(const std::string& repoDir = ".minigit")
+        : repoDir(repoDir), indexTimeNs(0), indexDirty(false), currentCommit(-1) {
+        if (load()) {
+            std::cout << "Opened Git repository with " << commits.size() << " commits." << std::endl;
+        } else {
+            std::cout << "Initialized new Git repository." << std::endl;
+        }
     }
 
-    // Initialize a new repository
+    ~GitManager() {
+        if (indexDirty) saveIndex();
+    }
+
+    // Initialize a new repository, discarding any existing history
     void init() {
-        files.clear();
+        stagedFiles.clear();
         commits.clear();
+        headTree.clear();
+        index.clear();
+        indexTimeNs = 0;
+        indexDirty = false;
         currentCommit = -1;
+
+        ::mkdir(repoDir.c_str(), 0755);
+        std::ofstream(packPath(), std::ios::trunc);
+        std::ofstream(logPath(), std::ios::trunc);
+        std::remove(indexPath().c_str());
+        if (!objects.open(packPath())) {
+            std::cout << "Cannot create repository in " << repoDir << std::endl;
+            return;
+        }
         std::cout << "Git repository initialized." << std::endl;
     }
 
-    // Add a file to the staging area
+    // Add a file to the staging area; its contents go to the object store now.
+    // A directory or glob pattern stages every file below it, hashed in parallel.
     void add(const std::string& fileName) {
-        stagedFiles.push_back(fileName);
-        std::cout << "Added file to staging: " << fileName << std::endl;
+        struct stat st;
+        if (fileName.find_first_of("*?[") != std::string::npos ||
+            (::stat(fileName.c_str(), &st) == 0 && S_ISDIR(st.st_mode))) {
+            addBulk(fileName);
+            return;
+        }
+
+        std::string path = normalizePath(fileName);
+        IndexEntry entry;
+        if (!hashFile(path, entry, true)) {
+            std::cout << "Cannot read file: " << fileName << std::endl;
+            return;
+        }
+        index[path] = entry;
+        indexDirty = true;
+        if (!stage(path, entry.blob)) {
+            std::cout << "File unchanged: " << path << std::endl;
+            return;
+        }
+        std::cout << "Added file to staging: " << path << std::endl;
+    }
+
+    // Stage the removal of a tracked file
+    void remove(const std::string& fileName) {
+        if (headTree.count(fileName) == 0) {
+            stagedFiles.erase(fileName);
+            std::cout << "File not tracked: " << fileName << std::endl;
+            return;
+        }
+        stagedFiles[fileName] = {ObjectId{}, true};
+        std::cout << "Staged removal: " << fileName << std::endl;
     }
 
     // Commit changes to the repository
@@ -31,36 +137,540 @@ public:
             return;
         }
 
+        Commit entry{message, currentCommit, {stagedFiles.begin(), stagedFiles.end()}};
+        std::sort(entry.changes.begin(), entry.changes.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        if (!appendCommit(entry)) {
+            std::cout << "Cannot write commit to " << logPath() << std::endl;
+            return;
+        }
+        applyChanges(headTree, entry.changes);
+        for (const auto& change : entry.changes) {
+            if (change.second.removed) indexDirty |= index.erase(change.first) != 0;
+        }
+        if (indexDirty) saveIndex();
+        commits.push_back(std::move(entry));
         currentCommit++;
-        commits[currentCommit] = {message, stagedFiles};
         stagedFiles.clear();
         std::cout << "Committed changes with message: \"" << message << "\"" << std::endl;
     }
 
-    // Show the current status of the repository
-    void status() const {
-        std::cout << "Staged files:" << std::endl;
+    // Show staged changes against HEAD and unstaged changes in the working tree.
+    // Tracked files are only re-hashed when their stat data no longer matches
+    // the index, so a clean tree costs one lstat() per file.
+    void status() {
+        std::cout << "Changes to be committed:" << std::endl;
+        std::map<std::string, TreeChange> staged(stagedFiles.begin(), stagedFiles.end());
+        for (const auto& file : staged) {
+            const char* kind = file.second.removed ? "deleted" : headTree.count(file.first) ? "modified" : "new";
+            std::cout << "  " << kind << ": " << file.first << std::endl;
+        }
+
+        // Every path the working tree should have, with the blob it should hold
+        std::vector<std::pair<const std::string*, ObjectId>> tracked;
+        tracked.reserve(headTree.size() + stagedFiles.size());
+        for (const auto& file : headTree) {
+            auto it = stagedFiles.find(file.first);
+            if (it == stagedFiles.end()) {
+                tracked.push_back({&file.first, file.second});
+            } else if (!it->second.removed) {
+                tracked.push_back({&file.first, it->second.blob});
+            }
+        }
         for (const auto& file : stagedFiles) {
-            std::cout << "  " << file << std::endl;
+            if (!file.second.removed && headTree.count(file.first) == 0) {
+                tracked.push_back({&file.first, file.second.blob});
+            }
         }
 
+        enum FileState : char { kClean, kModified, kDeleted };
+        std::vector<FileState> states(tracked.size(), kClean);
+        std::vector<IndexEntry> refreshed(tracked.size());
+        std::vector<char> rehashed(tracked.size(), 0);
+        auto check = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const std::string& path = *tracked[i].first;
+                struct stat st;
+                if (::lstat(path.c_str(), &st) != 0) {
+                    states[i] = kDeleted;
+                    continue;
+                }
+                auto cached = index.find(path);
+                ObjectId blob;
+                if (cached != index.end() && statMatches(cached->second, st)) {
+                    blob = cached->second.blob;
+                } else if (hashFile(path, refreshed[i], false)) {
+                    rehashed[i] = 1;
+                    blob = refreshed[i].blob;
+                } else {
+                    states[i] = kDeleted;
+                    continue;
+                }
+                states[i] = blob == tracked[i].second ? kClean : kModified;
+            }
+        };
+        if (tracked.size() < kParallelThreshold) {
+            check(0, tracked.size());
+        } else {
+            pool().parallelFor(tracked.size(), check);
+        }
+
+        std::map<std::string, FileState> unstaged;
+        for (size_t i = 0; i < tracked.size(); ++i) {
+            if (rehashed[i]) {
+                index[*tracked[i].first] = refreshed[i];
+                indexDirty = true;
+            }
+            if (states[i] != kClean) unstaged[*tracked[i].first] = states[i];
+        }
+        if (indexDirty) saveIndex();
+
+        std::cout << "Changes not staged for commit:" << std::endl;
+        for (const auto& file : unstaged) {
+            std::cout << "  " << (file.second == kDeleted ? "deleted" : "modified") << ": " << file.first << std::endl;
+        }
+    }
+
+    // Show the commit history with the changes of each commit
+    void log() const {
         std::cout << "Commits:" << std::endl;
-        for (const auto& commit : commits) {
-            std::cout << "Commit " << commit.first << ": " << commit.second.first << std::endl;
-            std::cout << "  Files:" << std::endl;
-            for (const auto& file : commit.second.second) {
-                std::cout << "    " << file << std::endl;
+        for (size_t i = 0; i < commits.size(); ++i) {
+            std::cout << "Commit " << i << ": " << commits[i].message << std::endl;
+            std::cout << "  Changes:" << std::endl;
+            for (const auto& change : commits[i].changes) {
+                std::cout << "    " << (change.second.removed ? "- " : "+ ") << change.first << std::endl;
             }
         }
+        std::cout << "Objects: " << objects.objectCount() << " (" << objects.packBytes() << " bytes packed)" << std::endl;
+    }
+
+    // Print a file as it was in the given commit
+    void show(int commitId, const std::string& fileName) const {
+        std::map<std::string, ObjectId> tree = treeAt(commitId);
+        auto it = tree.find(fileName);
+        std::string contents;
+        if (it == tree.end() || !objects.get(it->second, contents)) {
+            std::cout << fileName << " is not in commit " << commitId << std::endl;
+            return;
+        }
+        std::cout << fileName << " @ " << commitId << " (" << it->second.hex() << "):\n" << contents << std::endl;
+    }
+
+    size_t stagedCount() const { return stagedFiles.size(); }
+
+    // Path -> blob for every file of a commit; -1 is the empty tree
+    std::map<std::string, ObjectId> treeAt(int commitId) const {
+        if (commitId == currentCommit) return headTree;
+        std::map<std::string, ObjectId> tree;
+        for (int i = 0; i <= commitId && i < static_cast<int>(commits.size()); ++i) {
+            applyChanges(tree, commits[i].changes);
+        }
+        return tree;
     }
 
 private:
-    std::vector<std::string> stagedFiles; // Files staged for commit
-    std::map<int, std::pair<std::string, std::vector<std::string>>> commits; // Commit history
+    struct TreeChange {
+        ObjectId blob;
+        bool removed;
+    };
+
+    struct Commit {
+        std::string message;
+        int parent;
+        std::vector<std::pair<std::string, TreeChange>> changes; // Delta against parent
+    };
+
+    // What a tracked file looked like when it was last hashed
+    struct IndexEntry {
+        ObjectId blob;
+        int64_t mtimeNs;
+        uint64_t size;
+        uint64_t inode;
+    };
+
+    // Below this many files status() does not bother the pool
+    static const size_t kParallelThreshold = 1024;
+
+    static int64_t mtimeOf(const struct stat& st) {
+        return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+
+    // A file modified in the same timestamp tick as the index was written may
+    // have changed after it was hashed ("racily clean"), so it is never trusted
+    bool statMatches(const IndexEntry& entry, const struct stat& st) const {
+        int64_t mtime = mtimeOf(st);
+        return entry.mtimeNs == mtime && entry.size == static_cast<uint64_t>(st.st_size) &&
+               entry.inode == static_cast<uint64_t>(st.st_ino) && mtime < indexTimeNs;
+    }
+
+    // "a//b/./c/" -> "a/b/c", "./" -> ".", so one file has one spelling.
+    // ".." is left alone: resolving it would need the file system.
+    static std::string normalizePath(const std::string& path) {
+        std::string out = !path.empty() && path[0] == '/' ? "/" : "";
+        size_t pos = 0;
+        while (pos < path.size()) {
+            size_t slash = path.find('/', pos);
+            if (slash == std::string::npos) slash = path.size();
+            std::string_view part(path.data() + pos, slash - pos);
+            if (!part.empty() && part != ".") {
+                if (!out.empty() && out.back() != '/') out += '/';
+                out.append(part.data(), part.size());
+            }
+            pos = slash + 1;
+        }
+        return out.empty() ? "." : out;
+    }
+
+    // Whether path names repoDir, however either is spelled. Only a path
+    // ending in the repository's own name is resolved with realpath().
+    bool isRepoDir(const std::string& path) const {
+        if (repoRealPath.empty()) return false;
+        size_t nameStart = path.rfind('/') + 1; // npos + 1 == 0
+        if (path.compare(nameStart, std::string::npos, repoRealPath, repoRealPath.rfind('/') + 1,
+                         std::string::npos) != 0) {
+            return false;
+        }
+        char* real = ::realpath(path.c_str(), nullptr);
+        bool same = real != nullptr && repoRealPath == real;
+        std::free(real);
+        return same;
+    }
+
+    WorkStealingPool& pool() {
+        if (!workers) workers = std::make_unique<WorkStealingPool>();
+        return *workers;
+    }
+
+    // Stage blob for path unless HEAD already has it; false if unchanged
+    bool stage(const std::string& path, const ObjectId& blob) {
+        auto head = headTree.find(path);
+        if (head != headTree.end() && head->second == blob) {
+            stagedFiles.erase(path);
+            return false;
+        }
+        stagedFiles[path] = {blob, false};
+        return true;
+    }
+
+    // Hash a file and record its stat data in entry; with store the contents
+    // also go into the object store. Large files are mapped instead of copied.
+    // Called concurrently by the pool workers.
+    bool hashFile(const std::string& path, IndexEntry& entry, bool store) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        entry.mtimeNs = mtimeOf(st);
+        entry.size = static_cast<uint64_t>(st.st_size);
+        entry.inode = static_cast<uint64_t>(st.st_ino);
+
+        size_t size = static_cast<size_t>(st.st_size);
+        bool stored = false;
+        if (size >= kMapThreshold) {
+            void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                ::madvise(map, size, MADV_SEQUENTIAL);
+                std::string_view contents(static_cast<const char*>(map), size);
+                entry.blob = hashContent(contents);
+                stored = !store || objects.put(entry.blob, contents);
+                ::munmap(map, size);
+            }
+        } else {
+            static thread_local std::string buffer;
+            buffer.resize(size);
+            size_t done = 0;
+            ssize_t n = 1;
+            while (done < size && (n = ::read(fd, &buffer[done], size - done)) > 0) {
+                done += static_cast<size_t>(n);
+            }
+            if (n >= 0) {
+                std::string_view contents(buffer.data(), done); // File may have shrunk meanwhile
+                entry.blob = hashContent(contents);
+                stored = !store || objects.put(entry.blob, contents);
+            }
+        }
+        ::close(fd);
+        return stored;
+    }
+
+    // List the regular files below dir into found[worker]; subdirectories
+    // become tasks of their own so the walk itself runs in parallel
+    void walk(std::vector<std::vector<std::string>>& found, const std::string& dir) {
+        DIR* handle = ::opendir(dir.c_str());
+        if (handle == nullptr) return;
+        std::vector<std::string>& files = found[static_cast<size_t>(WorkStealingPool::currentWorker())];
+        std::string prefix = dir == "." ? "" : dir.back() == '/' ? dir : dir + "/";
+
+        while (dirent* entry = ::readdir(handle)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            std::string path = prefix + name;
+
+            unsigned char type = entry->d_type;
+            struct stat st;
+            if (type == DT_UNKNOWN && ::lstat(path.c_str(), &st) == 0) {
+                type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+            }
+            if (type == DT_DIR) {
+                if (isRepoDir(path)) continue;
+                pool().submit([this, &found, path] { walk(found, path); });
+            } else if (type == DT_REG) {
+                files.push_back(std::move(path));
+            }
+        }
+        ::closedir(handle);
+    }
+
+    // add() for a directory or glob: find, hash and store on the pool, then stage
+    void addBulk(const std::string& pattern) {
+        auto start = std::chrono::steady_clock::now();
+        WorkStealingPool& workers = pool();
+
+        std::vector<std::string> roots;
+        glob_t matches;
+        if (::glob(pattern.c_str(), GLOB_NOSORT, nullptr, &matches) == 0) {
+            roots.assign(matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+        }
+        ::globfree(&matches);
+
+        // Resolved once so walk() recognizes the repository under any spelling
+        char* real = ::realpath(repoDir.c_str(), nullptr);
+        repoRealPath = real != nullptr ? real : "";
+        std::free(real);
+
+        std::vector<std::vector<std::string>> found(workers.size() + 1); // Last one: plain files
+        for (std::string& root : roots) {
+            root = normalizePath(root);
+            struct stat st;
+            if (::stat(root.c_str(), &st) != 0) continue;
+            if (S_ISDIR(st.st_mode)) {
+                if (isRepoDir(root)) continue;
+                workers.submit([this, &found, root] { walk(found, root); });
+            } else if (S_ISREG(st.st_mode)) {
+                found.back().push_back(root);
+            }
+        }
+        workers.wait();
+
+        // Overlapping patterns can name a file twice; hash it once
+        size_t total = 0;
+        for (const auto& files : found) total += files.size();
+        std::unordered_set<std::string_view> seen;
+        seen.reserve(total);
+        std::vector<const std::string*> paths;
+        paths.reserve(total);
+        for (const auto& files : found) {
+            for (const auto& path : files) {
+                if (seen.insert(path).second) paths.push_back(&path);
+            }
+        }
+
+        std::vector<IndexEntry> entries(paths.size());
+        std::vector<char> stored(paths.size());
+        workers.parallelFor(paths.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                stored[i] = hashFile(*paths[i], entries[i], true);
+            }
+        });
+
+        size_t added = 0, unchanged = 0, failed = 0;
+        stagedFiles.reserve(stagedFiles.size() + paths.size());
+        index.reserve(index.size() + paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (!stored[i]) {
+                ++failed;
+                continue;
+            }
+            index[*paths[i]] = entries[i];
+            if (stage(*paths[i], entries[i].blob)) {
+                ++added;
+            } else {
+                ++unchanged;
+            }
+        }
+        indexDirty = true;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "Added " << added << " files to staging from " << pattern << " (" << unchanged
+                  << " unchanged, " << failed << " unreadable) in " << elapsed.count() << " ms" << std::endl;
+    }
+
+    std::string packPath() const { return repoDir + "/objects.pack"; }
+    std::string logPath() const { return repoDir + "/commits.log"; }
+    std::string indexPath() const { return repoDir + "/index"; }
+
+    // Rewrite the index through a temporary file so a crash leaves the old one
+    void saveIndex() {
+        std::string temp = indexPath() + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            uint64_t count = index.size();
+            out.write(kIndexMagic, sizeof(kIndexMagic));
+            out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            for (const auto& file : index) {
+                IndexRecord record{file.second.blob, file.second.mtimeNs, file.second.size, file.second.inode,
+                                   static_cast<uint32_t>(file.first.size()), 0};
+                out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+                out.write(file.first.data(), static_cast<std::streamsize>(file.first.size()));
+            }
+            if (!out.flush()) {
+                std::cout << "Cannot write index " << temp << std::endl;
+                return;
+            }
+        }
+        struct stat st;
+        if (std::rename(temp.c_str(), indexPath().c_str()) == 0 && ::stat(indexPath().c_str(), &st) == 0) {
+            indexTimeNs = mtimeOf(st);
+            indexDirty = false;
+        }
+    }
+
+    // A missing or damaged index only costs a re-hash on the next status()
+    void loadIndex() {
+        std::ifstream in(indexPath(), std::ios::binary);
+        char magic[sizeof(kIndexMagic)];
+        uint64_t count = 0;
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kIndexMagic, sizeof(magic)) != 0 ||
+            !in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+            return;
+        }
+        index.reserve(count);
+        IndexRecord record;
+        std::string path;
+        while (count-- > 0 && in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+            path.resize(record.pathLength);
+            if (!in.read(&path[0], record.pathLength)) break;
+            index[path] = {record.blob, record.mtimeNs, record.size, record.inode};
+        }
+        struct stat st;
+        if (::stat(indexPath().c_str(), &st) == 0) indexTimeNs = mtimeOf(st);
+    }
+
+    static void applyChanges(std::map<std::string, ObjectId>& tree,
+                             const std::vector<std::pair<std::string, TreeChange>>& changes) {
+        for (const auto& change : changes) {
+            if (change.second.removed) {
+                tree.erase(change.first);
+            } else {
+                tree[change.first] = change.second.blob;
+            }
+        }
+    }
+
+    bool appendCommit(const Commit& entry) {
+        std::ofstream out(logPath(), std::ios::binary | std::ios::app);
+        CommitRecord record{kCommitMagic, entry.parent, static_cast<uint32_t>(entry.message.size()),
+                            static_cast<uint32_t>(entry.changes.size())};
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        out.write(entry.message.data(), static_cast<std::streamsize>(entry.message.size()));
+        for (const auto& change : entry.changes) {
+            ChangeRecord changeRecord{change.second.blob, static_cast<uint32_t>(change.first.size()),
+                                      change.second.removed ? 1u : 0u};
+            out.write(reinterpret_cast<const char*>(&changeRecord), sizeof(changeRecord));
+            out.write(change.first.data(), static_cast<std::streamsize>(change.first.size()));
+        }
+        out.flush();
+        return static_cast<bool>(out);
+    }
+
+    // Read an existing repository; a torn last commit record is ignored
+    bool load() {
+        std::ifstream in(logPath(), std::ios::binary);
+        if (!in || !objects.open(packPath())) return false;
+
+        CommitRecord record;
+        while (in.read(reinterpret_cast<char*>(&record), sizeof(record)) && record.magic == kCommitMagic) {
+            Commit entry{std::string(record.messageLength, '\0'), record.parent, {}};
+            if (!in.read(&entry.message[0], record.messageLength)) break;
+
+            bool complete = true;
+            for (uint32_t i = 0; i < record.changeCount && complete; ++i) {
+                ChangeRecord changeRecord;
+                std::string path;
+                complete = static_cast<bool>(in.read(reinterpret_cast<char*>(&changeRecord), sizeof(changeRecord)));
+                if (complete) {
+                    path.resize(changeRecord.pathLength);
+                    complete = static_cast<bool>(in.read(&path[0], changeRecord.pathLength));
+                }
+                entry.changes.push_back({path, {changeRecord.blob, changeRecord.removed != 0}});
+            }
+            if (!complete) break;
+
+            applyChanges(headTree, entry.changes);
+            commits.push_back(std::move(entry));
+        }
+        currentCommit = static_cast<int>(commits.size()) - 1;
+        loadIndex();
+        return true;
+    }
+
+    std::string repoDir;
+    std::string repoRealPath;                      // repoDir resolved by realpath() for walk()
+    ObjectStore objects;                           // File contents by hash
+    std::unordered_map<std::string, TreeChange> stagedFiles; // Files staged for commit
+    std::vector<Commit> commits;                   // Commit history, index = commit ID
+    std::map<std::string, ObjectId> headTree;      // Files of the current commit
+    std::unordered_map<std::string, IndexEntry> index; // Stat cache of tracked files
+    int64_t indexTimeNs;                           // When the index file was last written
+    bool indexDirty;                               // index has changes not yet written
     int currentCommit; // ID of the current commit
+    std::unique_ptr<WorkStealingPool> workers; // Started by the first bulk add
 };
 
-int main() {
+// Stage a synthetic tree of fileCount files and report the hashing throughput
+void runBenchmark(size_t fileCount) {
+    const size_t filesPerDir = 1000;
+    const std::string root = "bench_tree";
+    std::cout << "Writing " << fileCount << " files to " << root << "..." << std::endl;
+    ::mkdir(root.c_str(), 0755);
+    std::string contents(512, 'x');
+    for (size_t i = 0; i < fileCount; ++i) {
+        std::string dir = root + "/d" + std::to_string(i / filesPerDir);
+        if (i % filesPerDir == 0) ::mkdir(dir.c_str(), 0755);
+        std::string text = std::to_string(i) + contents;
+        std::ofstream(dir + "/f" + std::to_string(i) + ".txt", std::ios::binary) << text;
+    }
+
+    GitManager git(".minigit-bench");
+    git.init();
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (const char* pass : {"cold", "unchanged"}) {
+        auto start = std::chrono::steady_clock::now();
+        git.add(root);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rate = static_cast<double>(fileCount) / seconds;
+        std::cout << pass << ": " << static_cast<uint64_t>(rate) << " files/s, "
+                  << static_cast<uint64_t>(rate / cores) << " files/s per core (" << cores << " cores)" << std::endl;
+        if (git.stagedCount() > 0) git.commit("Benchmark tree");
+    }
+
+    // Clean tree: one lstat() per file, nothing re-hashed
+    for (int touched : {0, 10}) {
+        for (int i = 0; i < touched; ++i) {
+            std::ofstream(root + "/d0/f" + std::to_string(i) + ".txt", std::ios::app) << "edit\n";
+        }
+        auto start = std::chrono::steady_clock::now();
+        git.status();
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        std::cout << "status with " << touched << " modified files: " << elapsed.count() << " ms" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmark(argc > 2 ? std::stoul(argv[2]) : 100000);
+        return 0;
+    }
+
+    // Sample working tree
+    std::ofstream("file1.txt") << "first file\n";
+    std::ofstream("file2.txt") << "second file\n";
+    std::ofstream("file3.txt") << "second file\n"; // Same contents: stored once
+
     GitManager git;
 
     git.init();
@@ -71,7 +681,17 @@ int main() {
     git.add("file3.txt");
     git.commit("Added file3");
 
+    std::ofstream("file1.txt") << "first file, edited\n";
+    git.add("file1.txt");
+    git.add("file2.txt"); // Unchanged, nothing to stage
+    git.remove("file3.txt");
+    git.commit("Edit file1, drop file3");
+
+    std::ofstream("file2.txt") << "second file, not staged\n";
     git.status();
+    git.log();
+    git.show(0, "file1.txt");
+    git.show(2, "file1.txt");
 
     return 0;
 }
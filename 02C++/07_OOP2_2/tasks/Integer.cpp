@@ -1,29 +1,270 @@
 #include <iostream>
+#include <algorithm>
+#include <cassert> // For assert
+#include <chrono>
+#include <cstdint>
+#include <cstdio>  // For snprintf
+#include <cstring> // For memcpy
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-class MyInteger {
-private:
-    int value;
+// Unsigned arithmetic on little-endian arrays of 64-bit limbs, the building
+// blocks of MyInteger. Sizes are in limbs; results never alias an operand
+// unless a function says so.
+namespace limbs {
+
+using Limb = uint64_t;
+using Wide = unsigned __int128;
+
+// Below this many limbs Karatsuba's extra additions cost more than the
+// multiplications it saves
+const size_t kKaratsubaLimbs = 32;
+
+// a and b without leading zero limbs
+inline int compare(const Limb* a, size_t an, const Limb* b, size_t bn) {
+    if (an != bn) return an < bn ? -1 : 1;
+    for (size_t i = an; i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// r = a + b for an >= bn, returning the carry out of limb an - 1. r may be a
+// or b: each limb is read before it is written.
+inline Limb add(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    Limb carry = 0;
+    for (size_t i = 0; i < bn; ++i) {
+        Wide sum = static_cast<Wide>(a[i]) + b[i] + carry;
+        r[i] = static_cast<Limb>(sum);
+        carry = static_cast<Limb>(sum >> 64);
+    }
+    for (size_t i = bn; i < an; ++i) {
+        r[i] = a[i] + carry;
+        carry = r[i] < carry;
+    }
+    return carry;
+}
+
+// r = a - b for an >= bn, returning the borrow; r may be a or b
+inline Limb sub(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    Limb borrow = 0;
+    for (size_t i = 0; i < bn; ++i) {
+        Limb x = a[i], y = b[i];
+        Limb diff = x - y - borrow;
+        borrow = (x < y) | ((x == y) & borrow);
+        r[i] = diff;
+    }
+    for (size_t i = bn; i < an; ++i) {
+        Limb x = a[i];
+        r[i] = x - borrow;
+        borrow = x < borrow;
+    }
+    return borrow;
+}
+
+// r[0, rn) += a[0, an) for an <= rn, returning the carry out of r
+inline Limb addTo(Limb* r, size_t rn, const Limb* a, size_t an) {
+    return add(r, r, rn, a, an);
+}
+
+// r[0, rn) -= a[0, an) for an <= rn, returning the borrow out of r
+inline Limb subFrom(Limb* r, size_t rn, const Limb* a, size_t an) {
+    return sub(r, r, rn, a, an);
+}
+
+// r[0, n) += a[0, n) * m, returning the limb carried out
+inline Limb mulAdd(Limb* r, const Limb* a, size_t n, Limb m) {
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        Wide product = static_cast<Wide>(a[i]) * m + r[i] + carry;
+        r[i] = static_cast<Limb>(product);
+        carry = static_cast<Limb>(product >> 64);
+    }
+    return carry;
+}
 
+// r[0, an + bn) = a * b, one row of partial products per limb of b
+inline void mulSchoolbook(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    std::fill(r, r + an, Limb(0));
+    for (size_t j = 0; j < bn; ++j) r[an + j] = mulAdd(r + j, a, an, b[j]);
+}
+
+// r[0, 2n) = a * b for two n-limb numbers. With a = a1 B + a0 and
+// b = b1 B + b0, the middle term a1 b0 + a0 b1 is (a0 + a1)(b0 + b1) minus
+// the outer two products, so each level does three half-size
+// multiplications instead of four: O(n^1.585) in all.
+inline void karatsuba(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    if (n < kKaratsubaLimbs) {
+        mulSchoolbook(r, a, n, b, n);
+        return;
+    }
+    size_t low = n / 2, high = n - low;
+    karatsuba(r, a, b, low);                                // a0 b0 in r[0, 2 low)
+    karatsuba(r + 2 * low, a + low, b + low, high);         // a1 b1 in r[2 low, 2n)
+    std::vector<Limb> scratch(4 * high + 4);
+    Limb* sumA = scratch.data();
+    Limb* sumB = sumA + high + 1;
+    Limb* middle = sumB + high + 1;                         // 2 high + 2 limbs
+    sumA[high] = add(sumA, a + low, high, a, low);
+    sumB[high] = add(sumB, b + low, high, b, low);
+    karatsuba(middle, sumA, sumB, high + 1);
+    subFrom(middle, 2 * high + 2, r, 2 * low);
+    subFrom(middle, 2 * high + 2, r + 2 * low, 2 * high);
+    addTo(r + low, 2 * n - low, middle, 2 * high + 2);
+}
+
+// r[0, an + bn) = a * b; Karatsuba once both are long enough
+inline void multiply(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn < kKaratsubaLimbs) {
+        mulSchoolbook(r, a, an, b, bn);
+        return;
+    }
+    if (an == bn) {
+        karatsuba(r, a, b, an);
+        return;
+    }
+    // Lopsided: bn-limb slices of a times b, added at their offsets
+    std::fill(r, r + an + bn, Limb(0));
+    std::vector<Limb> part(2 * bn);
+    for (size_t at = 0; at < an; at += bn) {
+        size_t length = std::min(bn, an - at);
+        multiply(part.data(), a + at, length, b, bn);
+        addTo(r + at, an + bn - at, part.data(), length + bn);
+    }
+}
+
+// q[0, n) = a / d, returning a % d; q may be a
+inline Limb divLimb(Limb* q, const Limb* a, size_t n, Limb d) {
+    Limb remainder = 0;
+    for (size_t i = n; i-- > 0;) {
+        Wide dividend = (static_cast<Wide>(remainder) << 64) | a[i];
+        q[i] = static_cast<Limb>(dividend / d);
+        remainder = static_cast<Limb>(dividend % d);
+    }
+    return remainder;
+}
+
+// q[0, an - bn + 1) = a / b and r[0, bn) = a % b, for an >= bn >= 2 and a
+// nonzero top limb in b (Knuth, TAOCP vol. 2, 4.3.1, algorithm D)
+inline void divmod(Limb* q, Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    // Shift so the divisor's top bit is set, which keeps each estimated
+    // quotient limb at most two too large
+    int shift = __builtin_clzll(b[bn - 1]);
+    std::vector<Limb> v(bn), u(an + 1);
+    for (size_t i = bn; i-- > 0;) {
+        v[i] = (b[i] << shift) | (shift && i > 0 ? b[i - 1] >> (64 - shift) : 0);
+    }
+    u[an] = shift ? a[an - 1] >> (64 - shift) : 0;
+    for (size_t i = an; i-- > 0;) {
+        u[i] = (a[i] << shift) | (shift && i > 0 ? a[i - 1] >> (64 - shift) : 0);
+    }
+
+    const Limb top = v[bn - 1], next = v[bn - 2];
+    for (size_t j = an - bn + 1; j-- > 0;) {
+        // Estimate from the top two limbs, then refine with the third
+        Limb estimate, rest;
+        bool restOverflow = false;
+        if (u[j + bn] >= top) {
+            estimate = ~Limb(0);
+            rest = u[j + bn - 1] + top;
+            restOverflow = rest < top;
+        } else {
+            Wide dividend = (static_cast<Wide>(u[j + bn]) << 64) | u[j + bn - 1];
+            estimate = static_cast<Limb>(dividend / top);
+            rest = static_cast<Limb>(dividend % top);
+        }
+        while (!restOverflow &&
+               static_cast<Wide>(estimate) * next > ((static_cast<Wide>(rest) << 64) | u[j + bn - 2])) {
+            --estimate;
+            rest += top;
+            restOverflow = rest < top;
+        }
+
+        // u[j, j + bn] -= estimate * v
+        Limb carry = 0, borrow = 0;
+        for (size_t i = 0; i < bn; ++i) {
+            Wide product = static_cast<Wide>(estimate) * v[i] + carry;
+            carry = static_cast<Limb>(product >> 64);
+            Limb low = static_cast<Limb>(product);
+            Limb x = u[i + j];
+            Limb diff = x - low - borrow;
+            borrow = (x < low) | ((x == low) & borrow);
+            u[i + j] = diff;
+        }
+        Limb x = u[j + bn];
+        u[j + bn] = x - carry - borrow;
+        bool negative = x < carry || (x == carry && borrow);
+
+        // Rarely one too many: add v back
+        if (negative) {
+            --estimate;
+            u[j + bn] += add(u.data() + j, u.data() + j, bn, v.data(), bn);
+        }
+        q[j] = estimate;
+    }
+    for (size_t i = 0; i < bn; ++i) {
+        r[i] = (u[i] >> shift) | (shift ? u[i + 1] << (64 - shift) : 0);
+    }
+}
+
+} // namespace limbs
+
+// Arbitrary-precision signed integer: a sign and a magnitude in 64-bit limbs,
+// least significant first.
+//
+// Values below 2^128 in magnitude live inside the object, so counters and
+// other small values never touch the heap, and when both operands fit in a
+// limb, +, - and * are done directly in 128-bit arithmetic. Larger values
+// go through the routines in limbs: multiplication switches to Karatsuba
+// from kKaratsubaLimbs limbs on. Decimal conversion splits the number in
+// halves by powers of 10^19, so both directions run in multiplication time:
+// parsing multiplies the halves back together, and printing divides by the
+// large powers through reciprocals computed with Newton's iteration, each
+// division a few multiplications instead of a quadratic algorithm D pass.
+class MyInteger {
 public:
+    using Limb = limbs::Limb;
+    static constexpr size_t kLocalLimbs = 2;
+
     // Default constructor
-    MyInteger() : value(0) {}
+    MyInteger() : limbs_(local_), size_(0), capacity_(kLocalLimbs), negative_(false) {}
 
-    // Parameterized constructor
-    MyInteger(int v) : value(v) {}
+    // Parameterized constructor, from any built-in integer
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    MyInteger(T v) : MyInteger() {
+        bool negative = false;
+        if constexpr (std::is_signed<T>::value) negative = v < 0;
+        Limb magnitude = static_cast<Limb>(v);
+        setMagnitude(negative ? Limb(0) - magnitude : magnitude, negative);
+    }
 
     // Copy constructor
-    MyInteger(const MyInteger& other) : value(other.value) {}
+    MyInteger(const MyInteger& other) : MyInteger() {
+        copyFrom(other);
+    }
 
-    // Move constructor
-    MyInteger(MyInteger&& other) noexcept : value(other.value) {}
+    // Move constructor: takes over a heap buffer
+    MyInteger(MyInteger&& other) noexcept : MyInteger() {
+        takeFrom(other);
+    }
 
     // Destructor
-    ~MyInteger() = default;
+    ~MyInteger() {
+        release();
+    }
 
     // Copy assignment operator
     MyInteger& operator=(const MyInteger& other) {
         if (this != &other) {
-            value = other.value;
+            copyFrom(other);
         }
         return *this;
     }
@@ -31,28 +272,645 @@ public:
     // Move assignment operator
     MyInteger& operator=(MyInteger&& other) noexcept {
         if (this != &other) {
-            value = other.value;
+            takeFrom(other);
         }
         return *this;
     }
 
+    bool isZero() const { return size_ == 0; }
+    bool isNegative() const { return negative_; }
+    size_t limbCount() const { return size_; }
+
+    // False if the value does not fit
+    bool toInt64(int64_t& value) const {
+        if (size_ > 1) return false;
+        Limb magnitude = size_ ? limbs_[0] : 0;
+        if (magnitude > (negative_ ? Limb(1) << 63 : (Limb(1) << 63) - 1)) return false;
+        value = negative_ ? static_cast<int64_t>(Limb(0) - magnitude) : static_cast<int64_t>(magnitude);
+        return true;
+    }
+
+    MyInteger operator-() const {
+        MyInteger result(*this);
+        if (size_ != 0) result.negative_ = !negative_;
+        return result;
+    }
+
+    MyInteger& operator+=(const MyInteger& other) { return addSigned(other, other.negative_); }
+    MyInteger& operator-=(const MyInteger& other) { return addSigned(other, !other.negative_); }
+    MyInteger& operator*=(const MyInteger& other) { return *this = *this * other; }
+    MyInteger& operator/=(const MyInteger& other) { return *this = *this / other; }
+    MyInteger& operator%=(const MyInteger& other) { return *this = *this % other; }
+
     // Addition operator
-    MyInteger operator+(const MyInteger& other) const {
-        return MyInteger(value + other.value);
+    friend MyInteger operator+(const MyInteger& a, const MyInteger& b) {
+        MyInteger result(a);
+        result += b;
+        return result;
+    }
+
+    friend MyInteger operator-(const MyInteger& a, const MyInteger& b) {
+        MyInteger result(a);
+        result -= b;
+        return result;
+    }
+
+    friend MyInteger operator*(const MyInteger& a, const MyInteger& b) {
+        MyInteger result;
+        bool negative = a.negative_ != b.negative_;
+        if (a.size_ <= 1 && b.size_ <= 1) {
+            result.setMagnitude(static_cast<limbs::Wide>(a.low()) * b.low(), negative);
+            return result;
+        }
+        result.prepare(a.size_ + b.size_);
+        limbs::multiply(result.limbs_, a.limbs_, a.size_, b.limbs_, b.size_);
+        result.finish(a.size_ + b.size_, negative);
+        return result;
+    }
+
+    // Truncates toward zero, like int
+    friend MyInteger operator/(const MyInteger& a, const MyInteger& b) {
+        MyInteger quotient, remainder;
+        divmod(a, b, quotient, remainder);
+        return quotient;
+    }
+
+    // Takes the sign of a, like int
+    friend MyInteger operator%(const MyInteger& a, const MyInteger& b) {
+        MyInteger quotient, remainder;
+        divmod(a, b, quotient, remainder);
+        return remainder;
+    }
+
+    // a = quotient * b + remainder, with the quotient truncated toward zero;
+    // b must not be zero. quotient and remainder may be a or b.
+    static void divmod(const MyInteger& a, const MyInteger& b, MyInteger& quotient, MyInteger& remainder) {
+        assert(!b.isZero());
+        MyInteger q, r;
+        bool negative = a.negative_ != b.negative_;
+        if (limbs::compare(a.limbs_, a.size_, b.limbs_, b.size_) < 0) {
+            r = a;
+        } else if (b.size_ == 1) {
+            q.prepare(a.size_);
+            Limb rest = limbs::divLimb(q.limbs_, a.limbs_, a.size_, b.limbs_[0]);
+            q.finish(a.size_, negative);
+            r.setMagnitude(rest, a.negative_);
+        } else {
+            size_t quotientSize = a.size_ - b.size_ + 1;
+            q.prepare(quotientSize);
+            r.prepare(b.size_);
+            limbs::divmod(q.limbs_, r.limbs_, a.limbs_, a.size_, b.limbs_, b.size_);
+            q.finish(quotientSize, negative);
+            r.finish(b.size_, a.negative_);
+        }
+        quotient = std::move(q);
+        remainder = std::move(r);
     }
 
     // Comparison operator
-    bool operator==(const MyInteger& other) const {
-        return value == other.value;
+    friend bool operator==(const MyInteger& a, const MyInteger& b) {
+        return a.negative_ == b.negative_ && limbs::compare(a.limbs_, a.size_, b.limbs_, b.size_) == 0;
+    }
+
+    friend bool operator!=(const MyInteger& a, const MyInteger& b) { return !(a == b); }
+
+    friend bool operator<(const MyInteger& a, const MyInteger& b) {
+        if (a.negative_ != b.negative_) return a.negative_;
+        int order = limbs::compare(a.limbs_, a.size_, b.limbs_, b.size_);
+        return a.negative_ ? order > 0 : order < 0;
+    }
+
+    friend bool operator>(const MyInteger& a, const MyInteger& b) { return b < a; }
+    friend bool operator<=(const MyInteger& a, const MyInteger& b) { return !(b < a); }
+    friend bool operator>=(const MyInteger& a, const MyInteger& b) { return !(a < b); }
+
+    // Digits in base 2, 10 or 16, with a leading '-' if negative
+    std::string toString(int base = 10) const {
+        assert(base == 2 || base == 10 || base == 16);
+        if (size_ == 0) return "0";
+        std::string text = negative_ ? "-" : "";
+        if (base == 10) {
+            MyInteger magnitude(*this);
+            magnitude.negative_ = false;
+            std::vector<MyInteger> powers = decimalPowers((size_ + 1) / 2);
+            std::vector<MyInteger> reciprocals(powers.size());
+            for (size_t k = 0; k < powers.size(); ++k) {
+                if (powers[k].size_ >= kReciprocalLimbs) reciprocals[k] = reciprocal(normalized(powers[k]));
+            }
+            appendDecimal(text, magnitude, 0, powers, reciprocals);
+        } else {
+            appendPowerOfTwo(text, base == 2 ? 1 : 4);
+        }
+        return text;
+    }
+
+    // Parse an optionally signed run of base 2, 10 or 16 digits; false and
+    // value unchanged if text is anything else
+    static bool fromString(std::string_view text, MyInteger& value, int base = 10) {
+        assert(base == 2 || base == 10 || base == 16);
+        bool negative = !text.empty() && text[0] == '-';
+        if (!text.empty() && (text[0] == '-' || text[0] == '+')) text.remove_prefix(1);
+        if (text.empty()) return false;
+        for (char c : text) {
+            if (digitValue(c) >= base) return false;
+        }
+        MyInteger result;
+        if (base == 10) {
+            std::vector<MyInteger> powers = decimalPowers(text.size() / 19 + 1);
+            parseDecimal(text, powers, result);
+        } else {
+            result.parsePowerOfTwo(text, base == 2 ? 1 : 4);
+        }
+        result.negative_ = negative && result.size_ != 0;
+        value = std::move(result);
+        return true;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const MyInteger& value) {
+        return out << value.toString();
     }
 
     // Print value
     void print() const {
-        std::cout << value;
+        std::cout << *this;
+    }
+
+    // a * b by schoolbook multiplication alone, the baseline for benchmarks
+    // and self-checks
+    static MyInteger multiplySchoolbook(const MyInteger& a, const MyInteger& b) {
+        MyInteger result;
+        result.prepare(a.size_ + b.size_);
+        if (a.size_ != 0 && b.size_ != 0) {
+            limbs::mulSchoolbook(result.limbs_, a.limbs_, a.size_, b.limbs_, b.size_);
+        }
+        result.finish(a.size_ && b.size_ ? a.size_ + b.size_ : 0, a.negative_ != b.negative_);
+        return result;
     }
+
+private:
+    // Up to this many limbs, decimal conversion goes 19 digits at a time
+    static const size_t kDecimalLimbs = 24;
+    // From this many limbs on, dividing by a power of 10^19 goes through its
+    // reciprocal; below, algorithm D is faster
+    static const size_t kReciprocalLimbs = 64;
+    static constexpr Limb kTen19 = 10000000000000000000ull;
+
+    bool isLocal() const { return limbs_ == local_; }
+    Limb low() const { return size_ ? limbs_[0] : 0; }
+
+    void release() {
+        if (!isLocal()) delete[] limbs_;
+        limbs_ = local_;
+        capacity_ = kLocalLimbs;
+    }
+
+    // Room for count limbs, keeping the current ones
+    void reserve(size_t count) {
+        if (count <= capacity_) return;
+        size_t capacity = std::max<size_t>(count, 2 * capacity_);
+        Limb* buffer = new Limb[capacity];
+        std::memcpy(buffer, limbs_, size_ * sizeof(Limb));
+        release();
+        limbs_ = buffer;
+        capacity_ = static_cast<uint32_t>(capacity);
+    }
+
+    // Room for count limbs, dropping the current value
+    void prepare(size_t count) {
+        size_ = 0;
+        negative_ = false;
+        reserve(count);
+    }
+
+    // The first count limbs are the magnitude; drop leading zeros
+    void finish(size_t count, bool negative) {
+        while (count > 0 && limbs_[count - 1] == 0) --count;
+        size_ = static_cast<uint32_t>(count);
+        negative_ = negative && count != 0;
+    }
+
+    // Magnitudes below 2^128 always fit: capacity_ is at least kLocalLimbs
+    void setMagnitude(limbs::Wide magnitude, bool negative) {
+        limbs_[0] = static_cast<Limb>(magnitude);
+        limbs_[1] = static_cast<Limb>(magnitude >> 64);
+        finish(2, negative);
+    }
+
+    void copyFrom(const MyInteger& other) {
+        prepare(other.size_);
+        std::memcpy(limbs_, other.limbs_, other.size_ * sizeof(Limb));
+        size_ = other.size_;
+        negative_ = other.negative_;
+    }
+
+    void takeFrom(MyInteger& other) {
+        if (other.isLocal()) {
+            copyFrom(other);
+        } else {
+            release();
+            limbs_ = other.limbs_;
+            capacity_ = other.capacity_;
+            size_ = other.size_;
+            negative_ = other.negative_;
+            other.limbs_ = other.local_;
+            other.capacity_ = kLocalLimbs;
+        }
+        other.size_ = 0;
+        other.negative_ = false;
+    }
+
+    // *this += other with other's sign taken as otherNegative, in place;
+    // other may be *this
+    MyInteger& addSigned(const MyInteger& other, bool otherNegative) {
+        if (size_ <= 1 && other.size_ <= 1) {
+            if (negative_ == otherNegative) {
+                // The usual counter step: one add, maybe a carry limb
+                Limb first = low(), sum = first + other.low();
+                limbs_[0] = sum;
+                limbs_[1] = sum < first;
+                finish(2, otherNegative);
+                return *this;
+            }
+            // Both below 2^64: the signed sum fits in 128 bits
+            __int128 x = negative_ ? -static_cast<__int128>(low()) : static_cast<__int128>(low());
+            __int128 y = otherNegative ? -static_cast<__int128>(other.low()) : static_cast<__int128>(other.low());
+            __int128 sum = x + y;
+            setMagnitude(sum < 0 ? -static_cast<limbs::Wide>(sum) : static_cast<limbs::Wide>(sum), sum < 0);
+            return *this;
+        }
+        size_t size = std::max(size_, other.size_);
+        if (negative_ == otherNegative || size_ == 0) {
+            // Same sign, or nothing yet: add the magnitudes
+            reserve(size + 1);
+            std::fill(limbs_ + size_, limbs_ + size, Limb(0));
+            limbs_[size] = limbs::add(limbs_, limbs_, size, other.limbs_, other.size_);
+            finish(size + 1, otherNegative);
+        } else if (limbs::compare(limbs_, size_, other.limbs_, other.size_) >= 0) {
+            limbs::sub(limbs_, limbs_, size_, other.limbs_, other.size_);
+            finish(size_, negative_);
+        } else {
+            // |other| - |*this|, which takes other's sign
+            reserve(size);
+            std::fill(limbs_ + size_, limbs_ + size, Limb(0));
+            limbs::sub(limbs_, other.limbs_, size, limbs_, size);
+            finish(size, otherNegative);
+        }
+        return *this;
+    }
+
+    static int digitValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return 99;
+    }
+
+    // 10^19, 10^38, 10^76, ...: 10^(19 * 2^k) up to about maxLimbs limbs,
+    // the split points of decimal conversion
+    static std::vector<MyInteger> decimalPowers(size_t maxLimbs) {
+        std::vector<MyInteger> powers(1, MyInteger(kTen19));
+        while (2 * powers.back().size_ <= maxLimbs) powers.push_back(powers.back() * powers.back());
+        return powers;
+    }
+
+    // v's limbs [from, from + count) with v's sign: v / B^from truncated
+    // toward zero, modulo B^count (B = 2^64)
+    static MyInteger limbSlice(const MyInteger& v, size_t from, size_t count = SIZE_MAX) {
+        MyInteger result;
+        if (from >= v.size_) return result;
+        count = std::min<size_t>(count, v.size_ - from);
+        result.prepare(count);
+        std::memcpy(result.limbs_, v.limbs_ + from, count * sizeof(Limb));
+        result.finish(count, v.negative_);
+        return result;
+    }
+
+    // v * B^count
+    static MyInteger shiftLimbs(const MyInteger& v, size_t count) {
+        MyInteger result;
+        if (v.size_ == 0) return result;
+        result.prepare(v.size_ + count);
+        std::fill(result.limbs_, result.limbs_ + count, Limb(0));
+        std::memcpy(result.limbs_ + count, v.limbs_, v.size_ * sizeof(Limb));
+        result.finish(v.size_ + count, v.negative_);
+        return result;
+    }
+
+    // d > 0 times the power of two that sets its top bit
+    static MyInteger normalized(const MyInteger& d) {
+        return d * MyInteger(Limb(1) << __builtin_clzll(d.limbs_[d.size_ - 1]));
+    }
+
+    // floor(B^2n / d) for an n-limb d with its top bit set. Newton's step
+    // x += x (B^2n - d x) / B^2n doubles the correct limbs of x, so it
+    // starts from the reciprocal of d's top half scaled up. That estimate
+    // has only half + 1 significant limbs and the correction only needs the
+    // top of the error, so each level costs about two n-limb multiplications.
+    static MyInteger reciprocal(const MyInteger& d) {
+        size_t n = d.size_;
+        MyInteger one(1);
+        MyInteger full = shiftLimbs(one, 2 * n);
+        if (n < kReciprocalLimbs) return full / d;
+
+        size_t half = (n + 1) / 2;
+        MyInteger top = reciprocal(limbSlice(d, n - half)); // x = top B^(n - half)
+        MyInteger error = full - shiftLimbs(d * top, n - half);
+        // x error / B^2n with error's low n - 1 limbs dropped, off by a unit or two
+        MyInteger correction = limbSlice(top * limbSlice(error, n - 1), half + 1);
+        MyInteger x = shiftLimbs(top, n - half) + correction;
+
+        // Now within a few units: make it exact
+        MyInteger rest = error - d * correction;
+        while (rest.negative_) {
+            x -= one;
+            rest += d;
+        }
+        while (rest >= d) {
+            x += one;
+            rest -= d;
+        }
+        return x;
+    }
+
+    // divmod() for a >= 0 and d > 0, given inverse = reciprocal(normalized(d)).
+    // a is divided n limbs at a time (Barrett): the top of each partial
+    // dividend times inverse estimates its quotient at most two too small,
+    // so a step is two multiplications and a correction or two.
+    static void divmodByReciprocal(const MyInteger& a, const MyInteger& d, const MyInteger& inverse,
+                                   MyInteger& quotient, MyInteger& remainder) {
+        MyInteger scale(Limb(1) << __builtin_clzll(d.limbs_[d.size_ - 1]));
+        MyInteger divisor = d * scale, dividend = a * scale;
+        size_t n = divisor.size_;
+        MyInteger one(1), q, r;
+        for (size_t block = (dividend.size_ + n - 1) / n; block-- > 0;) {
+            // r < divisor, so part < divisor B^n <= B^2n
+            MyInteger part = shiftLimbs(r, n) + limbSlice(dividend, block * n, n);
+            MyInteger estimate = limbSlice(limbSlice(part, n - 1) * inverse, n + 1);
+            r = part - estimate * divisor;
+            while (r >= divisor) {
+                r -= divisor;
+                estimate += one;
+            }
+            q = shiftLimbs(q, n) + estimate;
+        }
+        quotient = std::move(q);
+        remainder = r / scale;
+    }
+
+    // value >= 0 in decimal, left-padded with zeros to width digits; the
+    // digits of a zero value with no width are "0". reciprocals[k] is set
+    // for the powers of at least kReciprocalLimbs limbs.
+    static void appendDecimal(std::string& text, const MyInteger& value, size_t width,
+                              const std::vector<MyInteger>& powers, const std::vector<MyInteger>& reciprocals) {
+        if (value.size_ > kDecimalLimbs) {
+            // Split at the largest power with at most half value's limbs:
+            // high digits from the quotient, exactly 19 * 2^k low ones from
+            // the remainder
+            size_t k = powers.size();
+            while (--k > 0 && 2 * powers[k].size_ > value.size_ + 1) {
+            }
+            size_t lowDigits = size_t(19) << k;
+            MyInteger high, low;
+            if (powers[k].size_ >= kReciprocalLimbs) {
+                divmodByReciprocal(value, powers[k], reciprocals[k], high, low);
+            } else {
+                divmod(value, powers[k], high, low);
+            }
+            appendDecimal(text, high, width > lowDigits ? width - lowDigits : 0, powers, reciprocals);
+            appendDecimal(text, low, lowDigits, powers, reciprocals);
+            return;
+        }
+
+        // 19 digits per division by 10^19, least significant first
+        std::vector<Limb> rest(value.limbs_, value.limbs_ + value.size_);
+        std::vector<Limb> chunks;
+        size_t size = rest.size();
+        while (size > 0) {
+            chunks.push_back(limbs::divLimb(rest.data(), rest.data(), size, kTen19));
+            while (size > 0 && rest[size - 1] == 0) --size;
+        }
+        std::string digits = chunks.empty() ? "" : std::to_string(chunks.back());
+        for (size_t i = chunks.size(); i > 1; --i) {
+            std::string chunk = std::to_string(chunks[i - 2]);
+            digits.append(19 - chunk.size(), '0');
+            digits += chunk;
+        }
+        if (digits.empty() && width == 0) digits = "0";
+        if (digits.size() < width) text.append(width - digits.size(), '0');
+        text += digits;
+    }
+
+    // Decimal digits into value: halves multiplied back together by a power
+    // of 10^19 for long inputs
+    static void parseDecimal(std::string_view digits, const std::vector<MyInteger>& powers, MyInteger& value) {
+        if (digits.size() > 19 * kDecimalLimbs) {
+            size_t k = powers.size() - 1;
+            while (k > 0 && (size_t(19) << k) >= digits.size()) --k;
+            size_t lowDigits = size_t(19) << k;
+            MyInteger high, low;
+            parseDecimal(digits.substr(0, digits.size() - lowDigits), powers, high);
+            parseDecimal(digits.substr(digits.size() - lowDigits), powers, low);
+            value = high * powers[k] + low;
+            return;
+        }
+
+        // value = value * 10^n + next n digits, up to 19 at a time
+        value.prepare(digits.size() / 19 + 1);
+        size_t size = 0;
+        for (size_t at = 0; at < digits.size();) {
+            size_t count = at == 0 && digits.size() % 19 ? digits.size() % 19 : 19;
+            Limb chunk = 0, scale = 1;
+            for (size_t i = 0; i < count; ++i, scale *= 10) chunk = chunk * 10 + static_cast<Limb>(digits[at + i] - '0');
+            Limb carry = chunk;
+            for (size_t i = 0; i < size; ++i) {
+                limbs::Wide product = static_cast<limbs::Wide>(value.limbs_[i]) * scale + carry;
+                value.limbs_[i] = static_cast<Limb>(product);
+                carry = static_cast<Limb>(product >> 64);
+            }
+            if (carry != 0) value.limbs_[size++] = carry;
+            at += count;
+        }
+        value.finish(size, false);
+    }
+
+    // Digits of bits bits each, which never straddle two limbs
+    void appendPowerOfTwo(std::string& text, int bits) const {
+        const char* kDigits = "0123456789abcdef";
+        size_t totalBits = 64 * (size_ - 1) + (64 - __builtin_clzll(limbs_[size_ - 1]));
+        for (size_t digit = (totalBits + bits - 1) / bits; digit-- > 0;) {
+            size_t bit = digit * bits;
+            text += kDigits[(limbs_[bit / 64] >> (bit % 64)) & ((1u << bits) - 1)];
+        }
+    }
+
+    void parsePowerOfTwo(std::string_view digits, int bits) {
+        size_t count = (digits.size() * bits + 63) / 64;
+        prepare(count);
+        std::fill(limbs_, limbs_ + count, Limb(0));
+        for (size_t digit = 0; digit < digits.size(); ++digit) {
+            size_t bit = digit * bits;
+            limbs_[bit / 64] |= static_cast<Limb>(digitValue(digits[digits.size() - 1 - digit])) << (bit % 64);
+        }
+        finish(count, false);
+    }
+
+    Limb* limbs_;       // local_, or a heap array of capacity_ limbs
+    uint32_t size_;     // Limbs in use, the top one nonzero; none for zero
+    uint32_t capacity_;
+    bool negative_;     // Never set for zero
+    Limb local_[kLocalLimbs];
 };
 
-int main() {
+// Random value of exactly limbCount limbs, either sign
+inline MyInteger randomInteger(std::mt19937_64& random, size_t limbCount) {
+    std::string hex = random() % 2 ? "-" : "";
+    for (size_t i = 0; i < limbCount; ++i) {
+        char limb[17];
+        std::snprintf(limb, sizeof(limb), "%016llx", static_cast<unsigned long long>(random() | (i == 0 ? 1ull << 63 : 0)));
+        hex += limb;
+    }
+    MyInteger value;
+    MyInteger::fromString(hex, value, 16);
+    return value;
+}
+
+// Multiplication at growing sizes against schoolbook, decimal conversion,
+// and a small-value counter
+inline void benchmarkInteger() {
+    using Clock = std::chrono::steady_clock;
+    auto msSince = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    std::mt19937_64 random(1);
+
+    for (size_t limbCount = 8; limbCount <= 8192; limbCount *= 4) {
+        MyInteger a = randomInteger(random, limbCount), b = randomInteger(random, limbCount);
+        size_t repeats = std::max<size_t>(1, (1u << 22) / (limbCount * limbCount));
+        auto start = Clock::now();
+        MyInteger fast;
+        for (size_t i = 0; i < repeats; ++i) fast = a * b;
+        double karatsuba = msSince(start) / repeats;
+        start = Clock::now();
+        MyInteger slow;
+        for (size_t i = 0; i < repeats; ++i) slow = MyInteger::multiplySchoolbook(a, b);
+        double schoolbook = msSince(start) / repeats;
+        std::cout << limbCount << " limbs: multiply " << karatsuba << " ms, schoolbook " << schoolbook << " ms ("
+                  << schoolbook / karatsuba << "x)" << (fast == slow ? "" : "  MISMATCH") << std::endl;
+    }
+
+    MyInteger big = randomInteger(random, 20000); // About 385,000 digits
+    auto start = Clock::now();
+    std::string decimal = big.toString();
+    double print = msSince(start);
+    start = Clock::now();
+    MyInteger parsed;
+    MyInteger::fromString(decimal, parsed);
+    double parse = msSince(start);
+    start = Clock::now();
+    std::string binary = big.toString(2);
+    double printBinary = msSince(start);
+    std::cout << decimal.size() << " digits: to decimal " << print << " ms, from decimal " << parse
+              << " ms, to binary " << printBinary << " ms" << (parsed == big ? "" : "  MISMATCH") << std::endl;
+
+    const size_t steps = 10000000;
+    MyInteger counter, step(12345);
+    start = Clock::now();
+    for (size_t i = 0; i < steps; ++i) counter += step;
+    std::cout << "counter += small: " << msSince(start) * 1e6 / steps << " ns/op (" << counter << ")" << std::endl;
+}
+
+// Decimal digits of v, independently of MyInteger
+inline std::string wideString(__int128 v) {
+    unsigned __int128 magnitude = v < 0 ? -static_cast<unsigned __int128>(v) : static_cast<unsigned __int128>(v);
+    std::string digits;
+    do {
+        digits += static_cast<char>('0' + static_cast<int>(magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (v < 0) digits += '-';
+    return std::string(digits.rbegin(), digits.rend());
+}
+
+// Random operands of sizes around every threshold, checked against
+// identities, schoolbook multiplication and 128-bit arithmetic. Returns
+// false on the first mismatch.
+inline bool checkInteger(size_t rounds) {
+    std::mt19937_64 random(5);
+    const size_t sizes[] = {0, 1, 2, 3, 5, 24, 25, 31, 32, 33, 47, 64, 100, 150};
+    auto pick = [&] { return sizes[random() % (sizeof(sizes) / sizeof(sizes[0]))] + random() % 3; };
+    auto fail = [](const char* what) {
+        std::cout << "MyInteger " << what << " is wrong" << std::endl;
+        return false;
+    };
+
+    for (size_t round = 0; round < rounds; ++round) {
+        MyInteger a = randomInteger(random, pick()), b = randomInteger(random, pick());
+        if (a * b != MyInteger::multiplySchoolbook(a, b)) return fail("multiplication");
+        if ((a + b) - b != a || a - a != MyInteger() || (a + b) * (a - b) != a * a - b * b) return fail("add/sub");
+        if (!b.isZero()) {
+            MyInteger q, r;
+            MyInteger::divmod(a, b, q, r);
+            MyInteger absR = r.isNegative() ? -r : r, absB = b.isNegative() ? -b : b;
+            if (q * b + r != a || absR >= absB || (!r.isZero() && r.isNegative() != a.isNegative())) {
+                return fail("division");
+            }
+        }
+        for (int base : {2, 10, 16}) {
+            MyInteger back;
+            if (!MyInteger::fromString(a.toString(base), back, base) || back != a) return fail("conversion");
+        }
+
+        // Small values against __int128
+        int64_t x = static_cast<int64_t>(random()) >> (random() % 64);
+        int64_t y = static_cast<int64_t>(random()) >> (random() % 64);
+        uint64_t u = random(), v = random();
+        MyInteger mx(x), my(y);
+        if ((mx + my).toString() != wideString(static_cast<__int128>(x) + y) ||
+            (MyInteger(u) + MyInteger(v)).toString() != wideString(static_cast<__int128>(u) + v) ||
+            (-MyInteger(u) - MyInteger(v)).toString() != wideString(-static_cast<__int128>(u) - v) ||
+            (mx - my).toString() != wideString(static_cast<__int128>(x) - y) ||
+            (mx * my).toString() != wideString(static_cast<__int128>(x) * y) ||
+            (y != 0 && (mx / my != MyInteger(x / y) || mx % my != MyInteger(x % y)))) {
+            return fail("small-value arithmetic");
+        }
+        int64_t back = 0;
+        if (!mx.toInt64(back) || back != x) return fail("toInt64");
+    }
+
+    // Decimal strings of powers of ten, built by repeated multiplication
+    MyInteger power(1);
+    std::string digits = "1";
+    for (int i = 0; i < 3000; ++i) {
+        power *= 10;
+        digits += '0';
+        MyInteger parsed;
+        if (!MyInteger::fromString(digits, parsed) || parsed != power || power.toString() != digits) {
+            return fail("decimal conversion");
+        }
+    }
+
+    // Values long enough to be printed through reciprocals: random ones,
+    // 10^n - 1 for the largest remainders and 10^n for zero ones
+    for (size_t limbCount : {130, 300, 700, 2000}) {
+        MyInteger a = randomInteger(random, limbCount), back;
+        if (!MyInteger::fromString(a.toString(), back) || back != a) return fail("long decimal conversion");
+        for (const std::string& text : {std::string(19 * limbCount, '9'), "1" + std::string(19 * limbCount, '0')}) {
+            if (!MyInteger::fromString(text, back) || back.toString() != text) return fail("long decimal conversion");
+        }
+    }
+    std::cout << rounds << " rounds agree" << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        benchmarkInteger();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--check") {
+        return checkInteger(argc > 2 ? std::stoul(argv[2]) : 20000) ? 0 : 1;
+    }
+
     MyInteger num1(10);
     MyInteger num2(20);
     MyInteger num3 = num1 + num2;
@@ -63,6 +921,10 @@ int main() {
         std::cout << "num3 is 30" << std::endl;
     }
 
+    // No overflow: 2^64 * 2^64 and its factorization back
+    MyInteger big = MyInteger(~0ull) + 1;
+    MyInteger square = big * big;
+    std::cout << square << " = " << square.toString(16) << " (hex), / 2^64 = " << square / big << std::endl;
+
     return 0;
 }
-
@@ -0,0 +1,59 @@
+#include "LogRing.h"
+#include <iostream>
+#include <cstdlib>
+
+// Offline reader for Logger ring files: prints every record that survived,
+// oldest first. Works on rings left behind by a crashed or killed process.
+//
+// Usage: LogReader <ring file> [last N records]
+
+const char* levelName(uint16_t level) {
+    switch (level) {
+        case 0: return "INFO";
+        case 1: return "WARN";
+        case 2: return "ERROR";
+        default: return "?";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <ring file> [last N records]" << std::endl;
+        return 1;
+    }
+
+    int fd = ::open(argv[1], O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        std::cerr << "Cannot read " << argv[1] << std::endl;
+        ::close(fd);
+        return 1;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "Cannot map " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<LogRingEntry> entries = readLogRing(static_cast<const char*>(map), size);
+    size_t first = 0;
+    if (argc > 2) {
+        size_t last = std::strtoul(argv[2], nullptr, 10);
+        if (last < entries.size()) first = entries.size() - last;
+    }
+
+    for (size_t i = first; i < entries.size(); ++i) {
+        std::cout << "[" << levelName(entries[i].level) << "] " << entries[i].text << "\n";
+    }
+    std::cout.flush();
+
+    ::munmap(map, size);
+    return 0;
+}
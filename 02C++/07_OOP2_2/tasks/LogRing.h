@@ -0,0 +1,206 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Fixed-size, memory-mapped log ring file.
+//
+// Layout: a 4 KiB LogRingHeader page, then `capacity` bytes of records. Each
+// record is a LogRingRecord followed by its text, padded to 8 bytes. Appending
+// is a couple of memcpy()s into the shared mapping, so everything written
+// survives the process being killed. Once the ring is full the oldest records
+// are overwritten; a reader recovers every record whose checksum still matches.
+
+const char kLogRingMagic[8] = {'L', 'O', 'G', 'R', 'I', 'N', 'G', '1'};
+const uint32_t kLogRecordMagic = 0x4c4f4752; // "RGOL"
+const uint32_t kLogPadMagic = 0x50414444;    // Filler up to the end of the ring
+const size_t kLogRingHeaderSize = 4096;
+
+struct LogRingHeader {
+    char magic[8];
+    uint64_t capacity;    // Bytes in the record area
+    uint64_t writeOffset; // Total bytes ever written; position is writeOffset % capacity
+    uint64_t nextSeq;     // Sequence number of the next record
+    uint64_t clearedSeq;  // Records below this were cleared and are ignored
+};
+
+struct LogRingRecord {
+    uint32_t magic;
+    uint32_t length; // Text bytes that follow
+    uint64_t seq;
+    uint16_t level;
+    uint16_t reserved;
+    uint32_t checksum; // FNV-1a over seq, level, length and text
+};
+
+inline uint32_t logRingChecksum(const LogRingRecord& record, const char* text) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ p[i]) * 16777619u;
+        }
+    };
+    mix(&record.seq, sizeof(record.seq));
+    mix(&record.level, sizeof(record.level));
+    mix(&record.length, sizeof(record.length));
+    mix(text, record.length);
+    return hash;
+}
+
+inline size_t logRingAlign(size_t n) {
+    return (n + 7) & ~static_cast<size_t>(7);
+}
+
+// A record recovered from a ring
+struct LogRingEntry {
+    uint64_t seq;
+    uint16_t level;
+    std::string_view text; // Points into the mapping
+};
+
+// Recover every intact record of a mapped ring file, oldest first.
+// Records are 8-byte aligned, so every aligned offset is tried; torn or
+// half-overwritten records fail their checksum and are skipped.
+inline std::vector<LogRingEntry> readLogRing(const char* base, size_t size) {
+    std::vector<LogRingEntry> entries;
+    if (size < kLogRingHeaderSize + sizeof(LogRingRecord)) return entries;
+
+    LogRingHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kLogRingMagic, sizeof(kLogRingMagic)) != 0) return entries;
+
+    const char* area = base + kLogRingHeaderSize;
+    size_t capacity = std::min<size_t>(header.capacity, size - kLogRingHeaderSize);
+    for (size_t pos = 0; pos + sizeof(LogRingRecord) <= capacity; pos += 8) {
+        LogRingRecord record;
+        std::memcpy(&record, area + pos, sizeof(record));
+        if (record.magic != kLogRecordMagic) continue;
+        if (record.length > capacity - pos - sizeof(record)) continue;
+
+        const char* text = area + pos + sizeof(record);
+        if (record.checksum != logRingChecksum(record, text)) continue;
+        if (record.seq < header.clearedSeq) continue;
+
+        entries.push_back({record.seq, record.level, std::string_view(text, record.length)});
+        pos += logRingAlign(sizeof(record) + record.length) - 8;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const LogRingEntry& a, const LogRingEntry& b) { return a.seq < b.seq; });
+    return entries;
+}
+
+// Appends records to a ring file. Not thread-safe; the logger serializes calls.
+class LogRingWriter {
+public:
+    LogRingWriter() : fd_(-1), base_(nullptr), mapped_(0), header_(nullptr), capacity_(0) {}
+    ~LogRingWriter() { close(); }
+
+    LogRingWriter(const LogRingWriter&) = delete;
+    LogRingWriter& operator=(const LogRingWriter&) = delete;
+
+    // Opens or creates path with a record area of capacity bytes. An existing
+    // ring of the same size is continued, so earlier records stay readable.
+    bool open(const std::string& path, size_t capacity) {
+        close();
+        capacity = logRingAlign(std::max<size_t>(capacity, 64 * 1024));
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) return false;
+
+        size_t size = kLogRingHeaderSize + capacity;
+        struct stat st;
+        bool fresh = ::fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) != size;
+        if (fresh && ::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+            close();
+            return false;
+        }
+
+        void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base_ = static_cast<char*>(map);
+        mapped_ = size;
+        header_ = reinterpret_cast<LogRingHeader*>(base_);
+        capacity_ = capacity;
+
+        if (fresh || std::memcmp(header_->magic, kLogRingMagic, sizeof(kLogRingMagic)) != 0 ||
+            header_->capacity != capacity) {
+            std::memset(base_, 0, kLogRingHeaderSize);
+            header_->capacity = capacity;
+            std::memcpy(header_->magic, kLogRingMagic, sizeof(kLogRingMagic));
+        }
+        return true;
+    }
+
+    void close() {
+        if (base_ != nullptr) {
+            ::munmap(base_, mapped_);
+            base_ = nullptr;
+            header_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    bool isOpen() const { return base_ != nullptr; }
+
+    void append(uint16_t level, std::string_view text) {
+        if (base_ == nullptr) return;
+
+        LogRingRecord record{};
+        record.magic = kLogRecordMagic;
+        record.length = static_cast<uint32_t>(std::min(text.size(), capacity_ / 4));
+        record.level = level;
+        size_t size = logRingAlign(sizeof(record) + record.length);
+
+        char* area = base_ + kLogRingHeaderSize;
+        size_t pos = header_->writeOffset % capacity_;
+        if (capacity_ - pos < size) {
+            // Doesn't fit before the end: fill the rest and start over at the front
+            if (capacity_ - pos >= sizeof(LogRingRecord)) {
+                LogRingRecord pad{};
+                pad.magic = kLogPadMagic;
+                std::memcpy(area + pos, &pad, sizeof(pad));
+            }
+            header_->writeOffset += capacity_ - pos;
+            pos = 0;
+        }
+
+        record.seq = header_->nextSeq++;
+        record.checksum = logRingChecksum(record, text.data());
+        std::memcpy(area + pos + sizeof(record), text.data(), record.length);
+        std::memcpy(area + pos, &record, sizeof(record));
+        header_->writeOffset += size;
+    }
+
+    // Hide everything written so far from readers
+    void clear() {
+        if (header_ != nullptr) header_->clearedSeq = header_->nextSeq;
+    }
+
+    const char* data() const { return base_; }
+    size_t size() const { return mapped_; }
+
+private:
+    int fd_;
+    char* base_;
+    size_t mapped_;
+    LogRingHeader* header_;
+    size_t capacity_;
+};
+
+#endif // LOG_RING_H
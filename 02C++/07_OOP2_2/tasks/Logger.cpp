@@ -1,7 +1,21 @@
+
+#include "LogRing.h"
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <type_traits>
+#include <optional>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
 
 // Define log levels
 enum class LogLevel {
@@ -10,44 +24,503 @@ enum class LogLevel {
     Error
 };
 
+// Levels below this are compiled out of LOG()/LOG_DEFERRED statements entirely,
+// e.g. -DLOGGER_MIN_LEVEL=1 drops every Info statement from the binary
+#ifndef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL 0
+#endif
+
+constexpr LogLevel kMinCompiledLevel = static_cast<LogLevel>(LOGGER_MIN_LEVEL);
+
+// How a record's payload is encoded
+enum class RecordKind : uint16_t {
+    Text,    // Already formatted message text
+    Deferred // LogFormat pointer + binary arguments, formatted when the log is read
+};
+
+// Header in front of every stored record
+struct RecordHeader {
+    uint32_t length; // Payload bytes that follow
+    uint16_t level;
+    uint16_t kind;
+    uint64_t seq;    // Global order of the log statement
+};
+
+// Type tags of deferred arguments, fixed at compile time per call site
+enum class ArgType : uint8_t {
+    Int,     // int64_t
+    UInt,    // uint64_t
+    Double,  // double
+    Char,    // char
+    Bool,    // bool
+    String,  // uint32_t length + bytes
+    Pointer, // const void*
+    End
+};
+
+// Static description of a deferred log statement: only a pointer to it is stored per call
+struct LogFormat {
+    LogLevel level;
+    const char* format; // Each "{}" is replaced by the next argument
+};
+
+template<typename T>
+struct DependentFalse : std::false_type {};
+
+template<typename T>
+constexpr ArgType argTypeOf() {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>) return ArgType::Bool;
+    else if constexpr (std::is_same_v<U, char>) return ArgType::Char;
+    else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) return ArgType::Int;
+    else if constexpr (std::is_integral_v<U>) return ArgType::UInt;
+    else if constexpr (std::is_floating_point_v<U>) return ArgType::Double;
+    else if constexpr (std::is_convertible_v<U, std::string_view>) return ArgType::String;
+    else if constexpr (std::is_pointer_v<U>) return ArgType::Pointer;
+    else static_assert(DependentFalse<U>::value, "Unsupported deferred log argument type");
+}
+
+// Binary argument encoder writing into a fixed buffer. The caller sizes the buffer
+// for all fixed-size fields; string bytes beyond stringCapacity are truncated.
+class ArgWriter {
+public:
+    ArgWriter(char* data, size_t stringCapacity) : data_(data), capacity_(stringCapacity), used_(0) {}
+
+    template<typename T>
+    void put(const T& value) {
+        constexpr ArgType type = argTypeOf<T>();
+        if constexpr (type == ArgType::Int) raw(static_cast<int64_t>(value));
+        else if constexpr (type == ArgType::UInt) raw(static_cast<uint64_t>(value));
+        else if constexpr (type == ArgType::Double) raw(static_cast<double>(value));
+        else if constexpr (type == ArgType::Char || type == ArgType::Bool) raw(value);
+        else if constexpr (type == ArgType::Pointer) raw(static_cast<const void*>(value));
+        else {
+            std::string_view text(value);
+            size_t room = capacity_ > used_ ? capacity_ - used_ : 0;
+            uint32_t length = static_cast<uint32_t>(std::min(text.size(), room));
+            raw(length);
+            std::memcpy(data_ + used_, text.data(), length);
+            used_ += length;
+        }
+    }
+
+    template<typename T>
+    void raw(const T& value) {
+        std::memcpy(data_ + used_, &value, sizeof(T));
+        used_ += sizeof(T);
+    }
+
+    size_t size() const { return used_; }
+
+private:
+    char* data_;
+    size_t capacity_;
+    size_t used_;
+};
+
+// Lock-free single-producer / single-consumer byte ring.
+// Each logging thread owns one; only the logger's drainer reads from it.
+class ThreadLogBuffer {
+public:
+    explicit ThreadLogBuffer(size_t capacity)
+        : abandoned(false), capacity_(roundUp(capacity)), mask_(capacity_ - 1),
+          data_(new char[capacity_]), head_(0), tail_(0) {}
+
+    // Producer side; returns false if the record doesn't fit right now
+    bool tryWrite(const RecordHeader& header, const char* payload) {
+        size_t need = sizeof(RecordHeader) + header.length;
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        if (need > capacity_ - (head - tail)) return false;
+
+        copyIn(head, reinterpret_cast<const char*>(&header), sizeof(header));
+        copyIn(head + sizeof(header), payload, header.length);
+        head_.store(head + need, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; calls visit(header, payload) for every complete record
+    template<typename Visitor>
+    size_t drain(Visitor&& visit) {
+        size_t count = 0;
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        while (tail != head) {
+            RecordHeader header;
+            copyOut(tail, reinterpret_cast<char*>(&header), sizeof(header));
+            payload_.resize(header.length);
+            copyOut(tail + sizeof(header), &payload_[0], header.length);
+            tail += sizeof(header) + header.length;
+            visit(header, payload_.data());
+            ++count;
+        }
+        tail_.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    std::atomic<bool> abandoned; // Owning thread has exited
+
+private:
+    static size_t roundUp(size_t n) {
+        size_t p = 4096; // Always room for the largest deferred record
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    void copyIn(size_t pos, const char* src, size_t n) {
+        size_t start = pos & mask_;
+        size_t first = std::min(n, capacity_ - start);
+        std::memcpy(data_.get() + start, src, first);
+        std::memcpy(data_.get(), src + first, n - first);
+    }
+
+    void copyOut(size_t pos, char* dst, size_t n) const {
+        size_t start = pos & mask_;
+        size_t first = std::min(n, capacity_ - start);
+        std::memcpy(dst, data_.get() + start, first);
+        std::memcpy(dst + first, data_.get(), n - first);
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<char[]> data_;
+    std::string payload_; // Consumer-side scratch, reused between records
+    alignas(64) std::atomic<size_t> head_; // Written by the owning thread
+    alignas(64) std::atomic<size_t> tail_; // Written by the drainer
+};
+
 // Logger class definition
 class Logger {
 public:
+    // Largest deferred record built on the stack at the call site
+    static const size_t kMaxDeferredRecord = 512;
+
+    // One log statement. Collects everything streamed into it and hands the
+    // message, together with its level, to the logger when the statement ends.
+    class Stream {
+    public:
+        explicit Stream(LogLevel level) : level_(level) {
+            if (IsEnabled(level)) message_.emplace();
+        }
+        Stream(const Stream&) = delete;
+        Stream& operator=(const Stream&) = delete;
+
+        ~Stream() {
+            if (!message_) return; // Below the runtime threshold
+            std::string text = message_->str();
+            instance().write(level_, RecordKind::Text, text.data(), text.size());
+        }
+
+        // Overloaded insertion operator to handle log messages
+        template<typename T>
+        Stream& operator<<(const T& message) {
+            if (message_) *message_ << message;
+            return *this;
+        }
+
+    private:
+        LogLevel level_;
+        std::optional<std::ostringstream> message_; // Only built when the level is enabled
+    };
+
+    // True if statements at level are compiled in (checked at compile time)
+    static constexpr bool CompiledIn(LogLevel level) {
+        return static_cast<int>(level) >= static_cast<int>(kMinCompiledLevel);
+    }
+
+    // Runtime threshold: statements below it are dropped before formatting
+    static void SetLevel(LogLevel level) {
+        minLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled(LogLevel level) {
+        return static_cast<int>(level) >= minLevel.load(std::memory_order_relaxed);
+    }
+
     // Method to log messages with a specific level
-    static Logger& Log(LogLevel level) {
-        static Logger instance;
-        instance.currentLevel = level;
-        return instance;
+    static Stream Log(LogLevel level) {
+        return Stream(level);
     }
 
-    // Overloaded insertion operator to handle log messages
-    template<typename T>
-    Logger& operator<<(const T& message) {
-        std::stringstream ss;
-        ss << message;
-        logBuffer.push_back(formatMessage(ss.str()));
-        return *this;
+    // Deferred formatting: stores only &format and the raw argument bytes;
+    // the text is produced by Dump(). In async mode nothing is allocated
+    // here after a thread's first record, which creates its buffer. In
+    // synchronous mode the record is appended to logBuffer, which grows.
+    template<typename... Args>
+    static void LogDeferred(const LogFormat& format, const Args&... args) {
+        if (!IsEnabled(format.level)) return;
+        static constexpr ArgType types[] = {argTypeOf<Args>()..., ArgType::End};
+        // Two pointers, then at most 8 bytes per argument outside of string contents
+        constexpr size_t fixedBytes = 2 * sizeof(void*) + 8 * sizeof...(Args);
+        static_assert(fixedBytes < kMaxDeferredRecord, "Too many deferred log arguments");
+
+        char record[kMaxDeferredRecord];
+        ArgWriter writer(record, sizeof(record) - fixedBytes);
+        writer.raw(&format);
+        writer.raw(static_cast<const ArgType*>(types));
+        (writer.put(args), ...);
+        instance().write(format.level, RecordKind::Deferred, record, writer.size());
+    }
+
+    // Switch to asynchronous mode: every thread logs into its own lock-free
+    // buffer of bufferBytes and a background thread drains them into the log
+    static void StartAsync(size_t bufferBytes = 64 * 1024) {
+        Logger& logger = instance();
+        std::lock_guard<std::mutex> lock(logger.controlMutex);
+        if (logger.async) return;
+        logger.threadBufferBytes = bufferBytes;
+        logger.running = true;
+        logger.async = true;
+        logger.drainer = std::thread(&Logger::drainLoop, &logger);
+    }
+
+    // Back to synchronous mode; call once no other thread is logging
+    static void StopAsync() {
+        instance().stopAsync();
+    }
+
+    // Make everything logged so far visible to Dump()
+    static void Flush() {
+        instance().drainAll();
     }
 
     // Method to dump all log messages
     static void Dump() {
-        Logger& instance = Log(LogLevel::Info); // Use any level to access instance
-        for (const auto& msg : instance.logBuffer) {
-            std::cout << msg << std::endl;
+        Logger& logger = instance();
+        logger.drainAll();
+        std::lock_guard<std::mutex> lock(logger.bufferMutex);
+        if (logger.ring.isOpen()) {
+            for (const auto& entry : readLogRing(logger.ring.data(), logger.ring.size())) {
+                std::cout << formatMessage(static_cast<LogLevel>(entry.level), std::string(entry.text)) << std::endl;
+            }
+            return;
+        }
+
+        size_t offset = 0;
+        while (offset < logger.logBuffer.size()) {
+            RecordHeader header;
+            std::memcpy(&header, logger.logBuffer.data() + offset, sizeof(header));
+            offset += sizeof(header);
+            std::cout << formatRecord(header, logger.logBuffer.data() + offset) << std::endl;
+            offset += header.length;
         }
     }
 
     // Method to clear all log messages
     static void Clear() {
-        Logger& instance = Log(LogLevel::Info); // Use any level to access instance
-        instance.logBuffer.clear();
+        Logger& logger = instance();
+        logger.drainAll();
+        std::lock_guard<std::mutex> lock(logger.bufferMutex);
+        logger.logBuffer.clear();
+        logger.ring.clear();
+    }
+
+    // Store messages in a fixed-size memory-mapped ring file instead of memory.
+    // Memory use stays bounded and the newest `bytes` of logs survive a crash;
+    // read them back with the LogReader tool.
+    static bool OpenRingFile(const std::string& path, size_t bytes) {
+        Logger& logger = instance();
+        logger.drainAll();
+        std::lock_guard<std::mutex> lock(logger.bufferMutex);
+        return logger.ring.open(path, bytes);
+    }
+
+    static void CloseRingFile() {
+        Logger& logger = instance();
+        logger.drainAll();
+        std::lock_guard<std::mutex> lock(logger.bufferMutex);
+        logger.ring.close();
     }
 
 private:
-    // Format message with timestamp and log level
-    std::string formatMessage(const std::string& message) {
+    // Per-thread handle; marks the buffer abandoned when the thread exits
+    struct ThreadSlot {
+        std::shared_ptr<ThreadLogBuffer> buffer;
+        ~ThreadSlot() {
+            if (buffer) buffer->abandoned = true;
+        }
+    };
+
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    void write(LogLevel level, RecordKind kind, const char* payload, size_t length) {
+        RecordHeader header;
+        header.level = static_cast<uint16_t>(level);
+        header.kind = static_cast<uint16_t>(kind);
+        header.seq = nextSeq.fetch_add(1, std::memory_order_relaxed);
+
+        if (!async.load(std::memory_order_acquire)) {
+            header.length = static_cast<uint32_t>(length);
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            appendRecord(header, payload);
+            return;
+        }
+
+        ThreadLogBuffer& buffer = threadBuffer();
+        header.length = static_cast<uint32_t>(std::min(length, buffer.capacity() / 2));
+        // Full: wait for the drainer instead of dropping the message
+        while (!buffer.tryWrite(header, payload)) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Caller holds bufferMutex
+    void appendRecord(const RecordHeader& header, const char* payload) {
+        if (ring.isOpen()) {
+            // Deferred records point into this process, so they are formatted before they go to disk
+            ring.append(header.level, recordText(header, payload));
+            return;
+        }
+        const char* raw = reinterpret_cast<const char*>(&header);
+        logBuffer.insert(logBuffer.end(), raw, raw + sizeof(header));
+        logBuffer.insert(logBuffer.end(), payload, payload + header.length);
+    }
+
+    ThreadLogBuffer& threadBuffer() {
+        thread_local ThreadSlot slot;
+        if (!slot.buffer) {
+            slot.buffer = std::make_shared<ThreadLogBuffer>(threadBufferBytes);
+            std::lock_guard<std::mutex> lock(registryMutex);
+            threadBuffers.push_back(slot.buffer);
+        }
+        return *slot.buffer;
+    }
+
+    // Move everything from the per-thread buffers into logBuffer, in statement order
+    size_t drainAll() {
+        std::lock_guard<std::mutex> drainLock(drainMutex); // Buffers have a single consumer
+
+        std::vector<std::shared_ptr<ThreadLogBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffers = threadBuffers;
+        }
+
+        batch.clear();
+        batchBytes.clear();
+        for (auto& buffer : buffers) {
+            buffer->drain([this](const RecordHeader& header, const char* payload) {
+                batch.push_back({header, batchBytes.size()});
+                batchBytes.insert(batchBytes.end(), payload, payload + header.length);
+            });
+        }
+        std::sort(batch.begin(), batch.end(),
+                  [](const Pending& a, const Pending& b) { return a.header.seq < b.header.seq; });
+
+        if (!batch.empty()) {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            for (const auto& pending : batch) {
+                appendRecord(pending.header, batchBytes.data() + pending.offset);
+            }
+        }
+
+        // Forget buffers of threads that have exited once they are empty
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threadBuffers.erase(std::remove_if(threadBuffers.begin(), threadBuffers.end(),
+                                           [](const std::shared_ptr<ThreadLogBuffer>& buffer) {
+                                               return buffer->abandoned && buffer->empty();
+                                           }),
+                            threadBuffers.end());
+        return batch.size();
+    }
+
+    void drainLoop() {
+        while (running.load(std::memory_order_acquire)) {
+            if (drainAll() == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    void stopAsync() {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        if (!async) return;
+        running = false;
+        drainer.join();
+        drainAll();
+        async = false;
+    }
+
+    static std::string formatRecord(const RecordHeader& header, const char* payload) {
+        return formatMessage(static_cast<LogLevel>(header.level), recordText(header, payload));
+    }
+
+    // Message text of a record, without the level prefix
+    static std::string recordText(const RecordHeader& header, const char* payload) {
+        if (static_cast<RecordKind>(header.kind) == RecordKind::Text) {
+            return std::string(payload, header.length);
+        }
+        return formatDeferred(payload, header.length);
+    }
+
+    // Expand a deferred record: substitute the decoded arguments into the format string
+    static std::string formatDeferred(const char* payload, size_t length) {
+        const char* end = payload + length;
+        const LogFormat* format;
+        const ArgType* types;
+        std::memcpy(&format, payload, sizeof(format));
+        std::memcpy(&types, payload + sizeof(format), sizeof(types));
+        const char* args = payload + sizeof(format) + sizeof(types);
+
+        std::string out;
+        for (const char* f = format->format; *f != '\0'; ++f) {
+            if (f[0] != '{' || f[1] != '}' || *types == ArgType::End || args >= end) {
+                out += *f;
+                continue;
+            }
+            args = appendArg(out, *types++, args);
+            ++f;
+        }
+        return out;
+    }
+
+    template<typename T>
+    static T readArg(const char*& args) {
+        T value;
+        std::memcpy(&value, args, sizeof(T));
+        args += sizeof(T);
+        return value;
+    }
+
+    static const char* appendArg(std::string& out, ArgType type, const char* args) {
+        char number[32];
+        switch (type) {
+            case ArgType::Int: out += std::to_string(readArg<int64_t>(args)); break;
+            case ArgType::UInt: out += std::to_string(readArg<uint64_t>(args)); break;
+            case ArgType::Double:
+                std::snprintf(number, sizeof(number), "%g", readArg<double>(args));
+                out += number;
+                break;
+            case ArgType::Char: out += readArg<char>(args); break;
+            case ArgType::Bool: out += readArg<bool>(args) ? '1' : '0'; break;
+            case ArgType::Pointer:
+                std::snprintf(number, sizeof(number), "%p", readArg<const void*>(args));
+                out += number;
+                break;
+            case ArgType::String: {
+                uint32_t length = readArg<uint32_t>(args);
+                out.append(args, length);
+                args += length;
+                break;
+            }
+            case ArgType::End: break;
+        }
+        return args;
+    }
+
+    // Format message with its log level
+    static std::string formatMessage(LogLevel level, const std::string& message) {
         std::string levelStr;
-        switch (currentLevel) {
+        switch (level) {
             case LogLevel::Info: levelStr = "INFO"; break;
             case LogLevel::Warn: levelStr = "WARN"; break;
             case LogLevel::Error: levelStr = "ERROR"; break;
@@ -55,13 +528,57 @@ private:
         return "[" + levelStr + "] " + message;
     }
 
-    LogLevel currentLevel;
-    std::vector<std::string> logBuffer;
+    struct Pending {
+        RecordHeader header;
+        size_t offset; // Payload position in batchBytes
+    };
+
+    static inline std::atomic<int> minLevel{0}; // Runtime threshold, see SetLevel()
+
+    std::vector<char> logBuffer; // RecordHeader + payload, back to back
+    LogRingWriter ring;          // Replaces logBuffer while a ring file is open
+    std::mutex bufferMutex;
+
+    std::atomic<bool> async{false};
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> nextSeq{0};
+    size_t threadBufferBytes = 64 * 1024;
+    std::vector<std::shared_ptr<ThreadLogBuffer>> threadBuffers;
+    std::mutex registryMutex;
+    std::mutex drainMutex;
+    std::mutex controlMutex;
+    std::vector<Pending> batch; // Reused by drainAll()
+    std::vector<char> batchBytes;
+    std::thread drainer;
 
     // Private constructor to ensure singleton pattern
     Logger() {}
+
+    ~Logger() {
+        stopAsync();
+    }
 };
 
+// Filtered logging: LOG(LogLevel::Info) << "x = " << x;
+// The streamed arguments are not evaluated at all when the level is disabled,
+// and statements below LOGGER_MIN_LEVEL are discarded at compile time.
+// The empty branches keep a caller's own if/else binding correctly.
+#define LOG(level)                                                     \
+    if constexpr (!Logger::CompiledIn(level)) {}                       \
+    else if (!Logger::IsEnabled(level)) {}                             \
+    else Logger::Log(level)
+
+// Log with deferred formatting; the format descriptor is a static at the call site
+#define LOG_DEFERRED(level, fmt, ...)                                  \
+    do {                                                               \
+        if constexpr (Logger::CompiledIn(level)) {                     \
+            if (Logger::IsEnabled(level)) {                            \
+                static const LogFormat logFormat_{level, fmt};         \
+                Logger::LogDeferred(logFormat_, ##__VA_ARGS__);        \
+            }                                                          \
+        }                                                              \
+    } while (0)
+
 int main() {
     // Example usage of the Logger class
     Logger::Log(LogLevel::Info) << "This is an info message.";
@@ -76,5 +593,70 @@ int main() {
     std::cout << "Log Dump after Clear:" << std::endl;
     Logger::Dump(); // Should print nothing as the logs are cleared
 
+    // Asynchronous mode: several threads log at once, each message keeps its own level
+    Logger::StartAsync();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 4; ++i) {
+        workers.emplace_back([i] {
+            for (int n = 0; n < 3; ++n) {
+                Logger::Log(i % 2 ? LogLevel::Warn : LogLevel::Info) << "worker " << i << " step " << n;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    Logger::StopAsync();
+
+    std::cout << "Log Dump after async logging:" << std::endl;
+    Logger::Dump();
+    Logger::Clear();
+
+    // Deferred formatting: only the raw arguments are stored, text is built here in Dump()
+    const int iterations = 100000;
+    Logger::StartAsync(8 * 1024 * 1024);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        LOG_DEFERRED(LogLevel::Info, "sample {} value {} ok {}", i, i * 0.5, true);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    Logger::StopAsync();
+    std::cout << "Deferred log call: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations
+              << " ns" << std::endl;
+
+    Logger::Clear();
+    LOG_DEFERRED(LogLevel::Warn, "sensor {} reads {} ({})", "temp", 21.5, 'C');
+    std::cout << "Log Dump after deferred logging:" << std::endl;
+    Logger::Dump();
+    Logger::Clear();
+
+    // Level filtering: disabled statements never evaluate their arguments
+    Logger::SetLevel(LogLevel::Warn);
+    int evaluated = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        LOG(LogLevel::Info) << "expensive " << ++evaluated;
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Disabled log statement: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations
+              << " ns, arguments evaluated " << evaluated << " times" << std::endl;
+
+    LOG(LogLevel::Info) << "This info message is filtered out.";
+    LOG(LogLevel::Error) << "This error message passes the filter.";
+    std::cout << "Log Dump with level Warn:" << std::endl;
+    Logger::Dump();
+
+    // Bounded, crash-safe storage: the newest messages live in logs.ring
+    Logger::OpenRingFile("logs.ring", 1024 * 1024);
+    Logger::Clear();
+    for (int i = 0; i < 3; ++i) {
+        LOG(LogLevel::Warn) << "persisted message " << i;
+    }
+    std::cout << "Log Dump from ring file:" << std::endl;
+    Logger::Dump();
+    Logger::CloseRingFile();
+
     return 0;
 }
@@ -0,0 +1,334 @@
+#ifndef OBJECT_STORE_H
+#define OBJECT_STORE_H
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+// Content-addressed blob store backed by a single append-only pack file.
+//
+// Layout: an 8-byte magic, then one PackEntry per blob followed by its bytes.
+// A blob is named by the hash of its contents, so storing the same contents
+// twice costs nothing. The in-memory index (id -> offset) is rebuilt by one
+// scan of the pack when it is opened. Every blob is re-hashed on the way, and
+// the scan stops at a truncated entry, at the zero-filled gap an interrupted
+// write leaves, or at a blob whose bytes no longer hash to its id (a torn or
+// partly persisted write); the next put() overwrites from there.
+
+// 128-bit content hash: two XXH64 lanes with different seeds
+struct ObjectId {
+    uint64_t hi;
+    uint64_t lo;
+
+    bool operator==(const ObjectId& other) const { return hi == other.hi && lo == other.lo; }
+    bool operator!=(const ObjectId& other) const { return !(*this == other); }
+
+    std::string hex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(32, '0');
+        for (int i = 0; i < 16; ++i) {
+            out[15 - i] = digits[(hi >> (i * 4)) & 0xf];
+            out[31 - i] = digits[(lo >> (i * 4)) & 0xf];
+        }
+        return out;
+    }
+};
+
+struct ObjectIdHash {
+    size_t operator()(const ObjectId& id) const { return static_cast<size_t>(id.lo); }
+};
+
+namespace xxh64 {
+
+const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    return rotl(acc, 31) * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    acc ^= round(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+inline uint64_t hash(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    } else {
+        h = seed + kPrime5;
+    }
+
+    h += size;
+    for (; p + 8 <= end; p += 8) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= (*p) * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace xxh64
+
+inline ObjectId hashContent(std::string_view contents) {
+    return {xxh64::hash(contents.data(), contents.size(), 0),
+            xxh64::hash(contents.data(), contents.size(), 0x5bd1e9955bd1e995ULL)};
+}
+
+const char kPackMagic[8] = {'M', 'G', 'P', 'A', 'C', 'K', '0', '1'};
+
+struct PackEntry {
+    ObjectId id;
+    uint64_t size; // Blob bytes that follow
+};
+
+class ObjectStore {
+public:
+    ObjectStore() : fd_(-1), end_(0) {}
+    ~ObjectStore() { close(); }
+
+    ObjectStore(const ObjectStore&) = delete;
+    ObjectStore& operator=(const ObjectStore&) = delete;
+
+    // Opens or creates the pack at path and indexes the blobs it holds
+    bool open(const std::string& path) {
+        close();
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) return false;
+
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            close();
+            return false;
+        }
+        uint64_t fileSize = static_cast<uint64_t>(st.st_size);
+
+        char magic[sizeof(kPackMagic)];
+        if (fileSize < sizeof(magic)) {
+            iovec part = {const_cast<char*>(kPackMagic), sizeof(kPackMagic)};
+            if (!writeAt(&part, 1, 0)) {
+                close();
+                return false;
+            }
+            end_ = sizeof(kPackMagic);
+            return true;
+        }
+        if (::pread(fd_, magic, sizeof(magic), 0) != static_cast<ssize_t>(sizeof(magic)) ||
+            std::memcmp(magic, kPackMagic, sizeof(magic)) != 0) {
+            close();
+            return false;
+        }
+
+        uint64_t offset = sizeof(kPackMagic);
+        PackEntry entry;
+        std::string contents;
+        while (offset + sizeof(entry) <= fileSize &&
+               ::pread(fd_, &entry, sizeof(entry), static_cast<off_t>(offset)) == static_cast<ssize_t>(sizeof(entry)) &&
+               entry.size <= fileSize - offset - sizeof(entry) &&
+               (entry.id.hi | entry.id.lo) != 0) {
+            contents.resize(entry.size);
+            if (!readAt(&contents[0], entry.size, offset + sizeof(entry)) || hashContent(contents) != entry.id) {
+                break;
+            }
+            index_[entry.id] = {offset + sizeof(entry), entry.size};
+            offset += sizeof(entry) + entry.size;
+        }
+        end_ = offset;
+        return true;
+    }
+
+    void close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        index_.clear();
+        end_ = 0;
+    }
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Stores contents unless a blob with the same id is already present
+    ObjectId put(std::string_view contents) {
+        ObjectId id = hashContent(contents);
+        put(id, contents);
+        return id;
+    }
+
+    // Same, for contents the caller has already hashed. Returns false on a write error.
+    // Safe to call from several threads: only the space reservation is locked,
+    // the blobs themselves are written in parallel. A blob is indexed, and so
+    // visible to get() and contains(), only once it is completely written.
+    bool put(const ObjectId& id, std::string_view contents) {
+        if (fd_ < 0) return false;
+
+        uint64_t offset;
+        uint64_t size = sizeof(PackEntry) + contents.size();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Another thread writing the same blob: wait for its outcome
+            writing_.wait(lock, [&] { return inFlight_.count(id) == 0; });
+            if (index_.count(id) != 0) return true;
+            inFlight_.insert(id);
+            offset = end_;
+            end_ += size;
+        }
+
+        PackEntry entry{id, contents.size()};
+        iovec parts[2] = {{&entry, sizeof(entry)},
+                          {const_cast<char*>(contents.data()), contents.size()}};
+        bool written = writeAt(parts, 2, offset);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inFlight_.erase(id);
+            if (written) {
+                index_[id] = {offset + sizeof(PackEntry), contents.size()};
+            } else if (end_ == offset + size) {
+                end_ = offset; // Nothing was reserved after it: give the space back
+            }
+        }
+        writing_.notify_all();
+        return written;
+    }
+
+    bool contains(const ObjectId& id) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.count(id) != 0;
+    }
+
+    // Reads a blob back; false if it is unknown
+    bool get(const ObjectId& id, std::string& contents) const {
+        Location location;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = index_.find(id);
+            if (it == index_.end()) return false;
+            location = it->second;
+        }
+        contents.resize(location.size);
+        return readAt(&contents[0], location.size, location.offset);
+    }
+
+    size_t objectCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.size();
+    }
+
+    uint64_t packBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return end_;
+    }
+
+private:
+    struct Location {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    // Gathers parts into one pwritev() at offset, resuming after short writes
+    bool writeAt(iovec* parts, int count, uint64_t offset) {
+        while (count > 0) {
+            ssize_t n = ::pwritev(fd_, parts, count, static_cast<off_t>(offset));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            offset += static_cast<uint64_t>(n);
+            size_t done = static_cast<size_t>(n);
+            while (count > 0 && done >= parts->iov_len) {
+                done -= parts->iov_len;
+                ++parts;
+                --count;
+            }
+            if (count > 0) {
+                parts->iov_base = static_cast<char*>(parts->iov_base) + done;
+                parts->iov_len -= done;
+            }
+        }
+        return true;
+    }
+
+    bool readAt(char* data, size_t size, uint64_t offset) const {
+        while (size > 0) {
+            ssize_t n = ::pread(fd_, data, size, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    int fd_;
+    mutable std::mutex mutex_;        // Guards end_, index_ and inFlight_
+    std::condition_variable writing_; // Signalled when a put() leaves inFlight_
+    uint64_t end_;                    // Where the next entry goes
+    std::unordered_map<ObjectId, Location, ObjectIdHash> index_;
+    std::unordered_set<ObjectId, ObjectIdHash> inFlight_; // Reserved but not yet written
+};
+
+#endif // OBJECT_STORE_H
@@ -1,90 +1,872 @@
 #include <iostream>
-#include <cstring> // For strlen, strcpy
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <utility>
+#include <cstring> // For memcpy, strlen
 #include <cassert> // For assert
+#include <cstdint>
+#include "StringKernels.h"
 
-class MyString {
-private:
-    char* data std::endl;
+// String with its length and capacity cached, so size(), bounds checks and
+// appends never scan for the terminator.
+//
+// Strings of up to kLocalCapacity characters live inside the object (small
+// string optimization): copying or building one never touches the heap.
+// data_ always points at the characters, either local_ or a heap buffer, so
+// reading a character costs no branch. Appending grows the heap buffer
+// geometrically, which makes a run of appends amortized O(1) per character.
+// The characters are always followed by '\0', so c_str() is free.
+//
+// a + b + c does not build a MyString per '+': it yields a MyStringConcat
+// that records the pieces, and the MyString it is assigned to copies them
+// into a buffer allocated once with the total size.
+template <typename Left, typename Right>
+class MyStringConcat;
 
+class MyString {
 public:
+    static constexpr size_t kLocalCapacity = 15;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
     // Default constructor
-    MyString() : data(new char[1]{'\0'}) {}
+    MyString() noexcept : data_(local_), size_(0) {
+        local_[0] = '\0';
+    }
 
     // Parameterized constructor
-    MyString(const char* str) {
-        size_t length = std::strlen(str);
-        data = new char[length + 1];
-        std::strcpy(data, str);
+    MyString(const char* str) : MyString(str, std::strlen(str)) {}
+
+    MyString(const char* str, size_t length) : data_(local_), size_(0) {
+        local_[0] = '\0';
+        append(str, length);
     }
 
     // Copy constructor
-    MyString(const MyString& other) {
-        size_t length = std::strlen(other.data);
-        data = new char[length + 1];
-        std::strcpy(data, other.data);
+    MyString(const MyString& other) : MyString(other.data_, other.size_) {}
+
+    // The result of a + b + ...: one allocation of the exact size
+    template <typename Left, typename Right>
+    MyString(const MyStringConcat<Left, Right>& concat) : MyString() {
+        appendConcat(concat);
     }
 
-    // Move constructor
-    MyString(MyString&& other) noexcept : data(other.data) {
-        other.data = nullptr;
+    // Move constructor: steals a heap buffer, copies a local string
+    MyString(MyString&& other) noexcept : data_(local_), size_(other.size_) {
+        if (other.isLocal()) {
+            std::memcpy(local_, other.local_, other.size_ + 1);
+        } else {
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            other.data_ = other.local_;
+        }
+        other.size_ = 0;
+        other.local_[0] = '\0';
     }
 
     // Destructor
     ~MyString() {
-        delete[] data;
+        if (!isLocal()) delete[] data_;
     }
 
-    // Copy assignment operator
+    // Copy assignment operator: reuses the buffer when it is large enough
     MyString& operator=(const MyString& other) {
-        if (this != &other) {
-            delete[] data;
-            size_t length = std::strlen(other.data);
-            data = new char[length + 1];
-            std::strcpy(data, other.data);
-        }
+        if (this != &other) assign(other.data_, other.size_);
         return *this;
     }
 
     // Move assignment operator
     MyString& operator=(MyString&& other) noexcept {
         if (this != &other) {
-            delete[] data;
-            data = other.data;
-            other.data = nullptr;
+            if (!isLocal()) delete[] data_;
+            data_ = local_;
+            size_ = other.size_;
+            if (other.isLocal()) {
+                std::memcpy(local_, other.local_, other.size_ + 1);
+            } else {
+                data_ = other.data_;
+                capacity_ = other.capacity_;
+                other.data_ = other.local_;
+            }
+            other.size_ = 0;
+            other.local_[0] = '\0';
         }
         return *this;
     }
 
-    // Concatenate
-    MyString operator+(const MyString& other) const {
-        size_t length1 = std::strlen(data);
-        size_t length2 = std::strlen(other.data);
-        char* newData = new char[length1 + length2 + 1];
-        std::strcpy(newData, data);
-        std::strcat(newData, other.data);
-        MyString newString;
-        newString.data = newData;
-        return newString;
+    MyString& operator=(const char* str) {
+        return assign(str, std::strlen(str));
+    }
+
+    // Built aside first: the pieces may be this string's own characters
+    template <typename Left, typename Right>
+    MyString& operator=(const MyStringConcat<Left, Right>& concat) {
+        return *this = MyString(concat);
+    }
+
+    MyString& assign(const char* str, size_t length) {
+        if (length > capacity()) {
+            // str may point into this string, so it is copied before the old buffer goes
+            char* buffer = new char[length + 1];
+            std::memcpy(buffer, str, length);
+            release();
+            data_ = buffer;
+            capacity_ = length;
+        } else {
+            std::memmove(data_, str, length);
+        }
+        size_ = length;
+        data_[size_] = '\0';
+        return *this;
     }
 
+    size_t size() const { return size_; }
+    size_t length() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return isLocal() ? kLocalCapacity : capacity_; }
+
+    const char* c_str() const { return data_; }
+    const char* data() const { return data_; }
+
     // Access element
     char& operator[](size_t index) {
-        assert(index < std::strlen(data)); // Simple boundary check
-        return data[index];
+        assert(index < size_); // Boundary check against the cached length
+        return data_[index];
+    }
+
+    const char& operator[](size_t index) const {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    // Make room for at least newCapacity characters without changing the string
+    void reserve(size_t newCapacity) {
+        if (newCapacity > capacity()) reallocate(newCapacity);
+    }
+
+    void clear() {
+        size_ = 0;
+        data_[0] = '\0';
+    }
+
+    MyString& append(const char* str, size_t length) {
+        if (size_ + length > capacity()) {
+            // Keep str valid: it may point into the buffer being replaced
+            bool inside = str >= data_ && str < data_ + size_;
+            size_t offset = inside ? static_cast<size_t>(str - data_) : 0;
+            grow(size_ + length);
+            if (inside) str = data_ + offset;
+        }
+        std::memmove(data_ + size_, str, length);
+        size_ += length;
+        data_[size_] = '\0';
+        return *this;
+    }
+
+    MyString& append(const MyString& other) { return append(other.data_, other.size_); }
+    MyString& append(const char* str) { return append(str, std::strlen(str)); }
+
+    void push_back(char c) {
+        if (size_ == capacity()) grow(size_ + 1);
+        data_[size_++] = c;
+        data_[size_] = '\0';
+    }
+
+    MyString& operator+=(const MyString& other) { return append(other); }
+    MyString& operator+=(const char* str) { return append(str); }
+    MyString& operator+=(char c) {
+        push_back(c);
+        return *this;
+    }
+
+    template <typename Left, typename Right>
+    MyString& operator+=(const MyStringConcat<Left, Right>& concat) {
+        appendConcat(concat);
+        return *this;
+    }
+
+    friend bool operator==(const MyString& a, const MyString& b) {
+        return a.size_ == b.size_ && std::memcmp(a.data_, b.data_, a.size_) == 0;
+    }
+
+    friend bool operator!=(const MyString& a, const MyString& b) { return !(a == b); }
+    friend bool operator<(const MyString& a, const MyString& b) { return a.compare(b) < 0; }
+
+    // Searching, comparing, case conversion and counting go through the
+    // SSE2/AVX2 kernels of StringKernels.h
+
+    // First position at or after pos where str starts, or npos
+    size_t find(const char* str, size_t length, size_t pos = 0) const {
+        if (pos > size_) return npos;
+        size_t at = stringkernels::find(data_ + pos, size_ - pos, str, length);
+        return at == size_ - pos && length != 0 ? npos : pos + at;
+    }
+
+    size_t find(const MyString& str, size_t pos = 0) const { return find(str.data_, str.size_, pos); }
+    size_t find(const char* str, size_t pos = 0) const { return find(str, std::strlen(str), pos); }
+    size_t find(char c, size_t pos = 0) const { return find(&c, 1, pos); }
+
+    // First position at or after pos of any character of set, or npos
+    size_t find_first_of(const char* set, size_t length, size_t pos = 0) const {
+        if (pos >= size_) return npos;
+        size_t at = stringkernels::findFirstOf(data_ + pos, size_ - pos, set, length);
+        return at == size_ - pos ? npos : pos + at;
+    }
+
+    size_t find_first_of(const MyString& set, size_t pos = 0) const { return find_first_of(set.data_, set.size_, pos); }
+    size_t find_first_of(const char* set, size_t pos = 0) const { return find_first_of(set, std::strlen(set), pos); }
+
+    // Negative, zero or positive as this string sorts before, equal to or
+    // after other, comparing bytes as unsigned
+    int compare(const MyString& other) const { return stringkernels::compare(data_, size_, other.data_, other.size_); }
+    int compare(const char* str) const { return stringkernels::compare(data_, size_, str, std::strlen(str)); }
+
+    // ASCII letters only, in place
+    MyString& to_lower() {
+        stringkernels::toLower(data_, size_);
+        return *this;
+    }
+
+    MyString& to_upper() {
+        stringkernels::toUpper(data_, size_);
+        return *this;
+    }
+
+    // Vowels, digits and ASCII letters, in one pass
+    CharCounts char_counts() const { return stringkernels::countClasses(data_, size_); }
+
+    friend std::ostream& operator<<(std::ostream& out, const MyString& str) {
+        return out.write(str.data_, static_cast<std::streamsize>(str.size_));
     }
 
     // Print string
     void print() const {
-        std::cout << data;
+        std::cout << *this;
+    }
+
+private:
+    bool isLocal() const { return data_ == local_; }
+
+    // The pieces are copied before the old buffer goes, since they may be in it
+    template <typename Concat>
+    void appendConcat(const Concat& concat) {
+        size_t length = concat.size();
+        if (size_ + length <= capacity()) {
+            concat.copyTo(data_ + size_);
+        } else {
+            size_t newCapacity = std::max(size_ + length, 2 * capacity());
+            char* buffer = new char[newCapacity + 1];
+            std::memcpy(buffer, data_, size_);
+            concat.copyTo(buffer + size_);
+            release();
+            data_ = buffer;
+            capacity_ = newCapacity;
+        }
+        size_ += length;
+        data_[size_] = '\0';
+    }
+
+    // Geometric growth, so repeated appends copy each character O(1) times
+    void grow(size_t required) {
+        reallocate(std::max(required, 2 * capacity()));
+    }
+
+    void reallocate(size_t newCapacity) {
+        char* buffer = new char[newCapacity + 1];
+        std::memcpy(buffer, data_, size_ + 1);
+        release();
+        data_ = buffer;
+        capacity_ = newCapacity;
+    }
+
+    void release() {
+        if (!isLocal()) delete[] data_;
+        data_ = local_;
     }
+
+    char* data_;  // local_, or a heap buffer of capacity_ + 1 bytes
+    size_t size_;
+    union {
+        size_t capacity_;                 // Heap strings
+        char local_[kLocalCapacity + 1];  // Local strings, terminator included
+    };
 };
 
-int main() {
+// Characters one operand of a concatenation contributes, referred to in place
+class MyStringPiece {
+public:
+    MyStringPiece(const MyString& str) : data_(str.data()), size_(str.size()) {}
+    MyStringPiece(const char* str) : data_(str), size_(std::strlen(str)) {}
+
+    size_t size() const { return size_; }
+
+    char* copyTo(char* out) const {
+        std::memcpy(out, data_, size_);
+        return out + size_;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+};
+
+// Pending left + right. Nodes are held by value and pieces point at the
+// operands' characters, so an expression stays valid as long as its operands
+// do: keep the result in a MyString, not in an auto variable that outlives
+// the temporaries of the expression.
+template <typename Left, typename Right>
+class MyStringConcat {
+public:
+    MyStringConcat(const Left& left, const Right& right)
+        : left_(left), right_(right), size_(left.size() + right.size()) {}
+
+    size_t size() const { return size_; }
+
+    char* copyTo(char* out) const {
+        return right_.copyTo(left_.copyTo(out));
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const MyStringConcat& concat) {
+        return out << MyString(concat);
+    }
+
+private:
+    Left left_;
+    Right right_;
+    size_t size_;
+};
+
+inline MyStringConcat<MyStringPiece, MyStringPiece> operator+(const MyString& a, const MyString& b) {
+    return {a, b};
+}
+
+inline MyStringConcat<MyStringPiece, MyStringPiece> operator+(const MyString& a, const char* b) {
+    return {a, b};
+}
+
+inline MyStringConcat<MyStringPiece, MyStringPiece> operator+(const char* a, const MyString& b) {
+    return {a, b};
+}
+
+template <typename L, typename R>
+MyStringConcat<MyStringConcat<L, R>, MyStringPiece> operator+(const MyStringConcat<L, R>& a, const MyString& b) {
+    return {a, b};
+}
+
+template <typename L, typename R>
+MyStringConcat<MyStringConcat<L, R>, MyStringPiece> operator+(const MyStringConcat<L, R>& a, const char* b) {
+    return {a, b};
+}
+
+template <typename L, typename R>
+MyStringConcat<MyStringPiece, MyStringConcat<L, R>> operator+(const MyString& a, const MyStringConcat<L, R>& b) {
+    return {a, b};
+}
+
+template <typename L, typename R>
+MyStringConcat<MyStringPiece, MyStringConcat<L, R>> operator+(const char* a, const MyStringConcat<L, R>& b) {
+    return {a, b};
+}
+
+template <typename L1, typename R1, typename L2, typename R2>
+MyStringConcat<MyStringConcat<L1, R1>, MyStringConcat<L2, R2>> operator+(const MyStringConcat<L1, R1>& a,
+                                                                       const MyStringConcat<L2, R2>& b) {
+    return {a, b};
+}
+
+// Text as a balanced tree of chunks, for documents of megabytes edited in
+// the middle.
+//
+// Each node holds a chunk of text, which goes between the text of its left
+// and right subtrees, and the length of its whole subtree, so a position is
+// found by one walk down. The tree is kept AVL-balanced by join(), which
+// together with split() gives insert, erase and substr in O(log n) plus the
+// characters inserted. Nodes and chunks are immutable and shared, so copies
+// and substrings share structure with the original instead of copying text,
+// and an edit only rebuilds the nodes on its path.
+class MyRope {
+public:
+    static constexpr size_t kMaxChunk = 1024;
+
+    MyRope() = default;
+    MyRope(const char* text) : MyRope(text, std::strlen(text)) {}
+    MyRope(const char* text, size_t length) : root_(build(text, length)) {}
+    MyRope(const MyString& text) : MyRope(text.data(), text.size()) {}
+
+    size_t size() const { return lengthOf(root_); }
+    bool empty() const { return !root_; }
+
+    char operator[](size_t index) const {
+        assert(index < size());
+        const Node* node = root_.get();
+        while (true) {
+            size_t left = lengthOf(node->left);
+            if (index < left) {
+                node = node->left.get();
+            } else if (index - left < node->chunk->size()) {
+                return (*node->chunk)[index - left];
+            } else {
+                index -= left + node->chunk->size();
+                node = node->right.get();
+            }
+        }
+    }
+
+    void insert(size_t pos, const char* text, size_t length) {
+        assert(pos <= size());
+        if (length == 0) return;
+        // A short insert goes into the chunk at pos while that stays small
+        if (NodePtr patched = insertInChunk(root_, pos, text, length)) {
+            root_ = std::move(patched);
+            return;
+        }
+        insert(pos, build(text, length));
+    }
+
+    void insert(size_t pos, const char* text) { insert(pos, text, std::strlen(text)); }
+    void insert(size_t pos, const MyString& text) { insert(pos, text.data(), text.size()); }
+
+    // Shares other's nodes
+    void insert(size_t pos, const MyRope& other) {
+        assert(pos <= size());
+        insert(pos, other.root_);
+    }
+
+    void append(const char* text, size_t length) { insert(size(), text, length); }
+    void append(const MyRope& other) { insert(size(), other); }
+
+    void erase(size_t pos, size_t length) {
+        assert(pos <= size() && length <= size() - pos);
+        auto [left, rest] = split(root_, pos);
+        root_ = concat(left, split(rest, length).second);
+    }
+
+    // length characters from pos, sharing this rope's nodes
+    MyRope substr(size_t pos, size_t length) const {
+        assert(pos <= size() && length <= size() - pos);
+        MyRope result;
+        result.root_ = split(split(root_, pos).second, length).first;
+        return result;
+    }
+
+    // Call visit(data, size) for each chunk in order
+    template <typename Visit>
+    void forEachChunk(Visit visit) const {
+        forEachChunk(root_.get(), visit);
+    }
+
+    // The whole text in one allocation of the exact size
+    MyString str() const {
+        MyString text;
+        text.reserve(size());
+        forEachChunk([&text](const char* data, size_t size) { text.append(data, size); });
+        return text;
+    }
+
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+    using ChunkPtr = std::shared_ptr<const MyString>;
+
+    struct Node {
+        NodePtr left;
+        NodePtr right;
+        ChunkPtr chunk;
+        size_t length; // Of the whole subtree
+        int height;
+    };
+
+    static size_t lengthOf(const NodePtr& node) { return node ? node->length : 0; }
+    static int heightOf(const NodePtr& node) { return node ? node->height : 0; }
+
+    static NodePtr make(NodePtr left, ChunkPtr chunk, NodePtr right) {
+        size_t length = lengthOf(left) + chunk->size() + lengthOf(right);
+        int height = 1 + std::max(heightOf(left), heightOf(right));
+        return std::make_shared<const Node>(Node{std::move(left), std::move(right), std::move(chunk), length, height});
+    }
+
+    static ChunkPtr chunkOf(const char* text, size_t length) {
+        return std::make_shared<const MyString>(text, length);
+    }
+
+    // Balanced tree of text cut into chunks of at most kMaxChunk
+    static NodePtr build(const char* text, size_t length) {
+        if (length == 0) return nullptr;
+        size_t chunks = (length + kMaxChunk - 1) / kMaxChunk;
+        size_t chunkSize = (length + chunks - 1) / chunks; // Even sizes, none left tiny
+        return build(text, length, chunkSize);
+    }
+
+    static NodePtr build(const char* text, size_t length, size_t chunkSize) {
+        if (length == 0) return nullptr;
+        size_t chunks = (length + chunkSize - 1) / chunkSize;
+        size_t mid = chunks / 2 * chunkSize;
+        size_t midSize = std::min(chunkSize, length - mid);
+        return make(build(text, mid, chunkSize), chunkOf(text + mid, midSize),
+                    build(text + mid + midSize, length - mid - midSize, chunkSize));
+    }
+
+    static NodePtr rotateLeft(const NodePtr& node) {
+        const NodePtr& right = node->right;
+        return make(make(node->left, node->chunk, right->left), right->chunk, right->right);
+    }
+
+    static NodePtr rotateRight(const NodePtr& node) {
+        const NodePtr& left = node->left;
+        return make(left->left, left->chunk, make(left->right, node->chunk, node->right));
+    }
+
+    // left, chunk and right in order as one balanced tree, for any heights:
+    // walks down the taller side to where the shorter one fits, then
+    // rebalances on the way back up (Blelloch et al., "Just Join for
+    // Parallel Ordered Sets")
+    static NodePtr join(const NodePtr& left, ChunkPtr chunk, const NodePtr& right) {
+        if (heightOf(left) > heightOf(right) + 1) return joinRight(left, std::move(chunk), right);
+        if (heightOf(right) > heightOf(left) + 1) return joinLeft(left, std::move(chunk), right);
+        return make(left, std::move(chunk), right);
+    }
+
+    static NodePtr joinRight(const NodePtr& left, ChunkPtr chunk, const NodePtr& right) {
+        if (heightOf(left->right) <= heightOf(right) + 1) {
+            NodePtr joined = make(left->right, std::move(chunk), right);
+            if (heightOf(joined) <= heightOf(left->left) + 1) return make(left->left, left->chunk, joined);
+            return rotateLeft(make(left->left, left->chunk, rotateRight(joined)));
+        }
+        NodePtr joined = joinRight(left->right, std::move(chunk), right);
+        NodePtr result = make(left->left, left->chunk, joined);
+        return heightOf(joined) <= heightOf(left->left) + 1 ? result : rotateLeft(result);
+    }
+
+    static NodePtr joinLeft(const NodePtr& left, ChunkPtr chunk, const NodePtr& right) {
+        if (heightOf(right->left) <= heightOf(left) + 1) {
+            NodePtr joined = make(left, std::move(chunk), right->left);
+            if (heightOf(joined) <= heightOf(right->right) + 1) return make(joined, right->chunk, right->right);
+            return rotateRight(make(rotateLeft(joined), right->chunk, right->right));
+        }
+        NodePtr joined = joinLeft(left, std::move(chunk), right->left);
+        NodePtr result = make(joined, right->chunk, right->right);
+        return heightOf(joined) <= heightOf(right->right) + 1 ? result : rotateRight(result);
+    }
+
+    // The first pos characters and the rest
+    static std::pair<NodePtr, NodePtr> split(const NodePtr& node, size_t pos) {
+        if (!node) return {nullptr, nullptr};
+        size_t left = lengthOf(node->left);
+        size_t chunkEnd = left + node->chunk->size();
+        if (pos == left) return {node->left, join(nullptr, node->chunk, node->right)};
+        if (pos < left) {
+            auto [first, rest] = split(node->left, pos);
+            return {first, join(rest, node->chunk, node->right)};
+        }
+        if (pos >= chunkEnd) {
+            auto [first, rest] = split(node->right, pos - chunkEnd);
+            return {join(node->left, node->chunk, first), rest};
+        }
+        // Inside the chunk: cut it in two
+        size_t cut = pos - left;
+        const MyString& chunk = *node->chunk;
+        return {join(node->left, chunkOf(chunk.data(), cut), nullptr),
+                join(nullptr, chunkOf(chunk.data() + cut, chunk.size() - cut), node->right)};
+    }
+
+    // Everything but the last chunk, and that chunk
+    static std::pair<NodePtr, ChunkPtr> splitLast(const NodePtr& node) {
+        if (!node->right) return {node->left, node->chunk};
+        auto [rest, last] = splitLast(node->right);
+        return {join(node->left, node->chunk, rest), last};
+    }
+
+    static NodePtr concat(const NodePtr& left, const NodePtr& right) {
+        if (!left) return right;
+        if (!right) return left;
+        auto [rest, last] = splitLast(left);
+        return join(rest, std::move(last), right);
+    }
+
+    void insert(size_t pos, const NodePtr& text) {
+        auto [left, right] = split(root_, pos);
+        root_ = concat(concat(left, text), right);
+    }
+
+    // The tree with text inserted into the chunk that holds pos, rebuilding
+    // only the path to it; null if that chunk would outgrow kMaxChunk
+    static NodePtr insertInChunk(const NodePtr& node, size_t pos, const char* text, size_t length) {
+        if (!node) return nullptr;
+        size_t left = lengthOf(node->left);
+        size_t chunkEnd = left + node->chunk->size();
+        if (pos < left) {
+            NodePtr patched = insertInChunk(node->left, pos, text, length);
+            return patched ? make(patched, node->chunk, node->right) : nullptr;
+        }
+        if (pos > chunkEnd) {
+            NodePtr patched = insertInChunk(node->right, pos - chunkEnd, text, length);
+            return patched ? make(node->left, node->chunk, patched) : nullptr;
+        }
+        const MyString& chunk = *node->chunk;
+        if (chunk.size() + length > kMaxChunk) return nullptr;
+        size_t cut = pos - left;
+        MyString patched;
+        patched.reserve(chunk.size() + length);
+        patched.append(chunk.data(), cut);
+        patched.append(text, length);
+        patched.append(chunk.data() + cut, chunk.size() - cut);
+        return make(node->left, std::make_shared<const MyString>(std::move(patched)), node->right);
+    }
+
+    template <typename Visit>
+    static void forEachChunk(const Node* node, Visit& visit) {
+        if (!node) return;
+        forEachChunk(node->left.get(), visit);
+        visit(node->chunk->data(), node->chunk->size());
+        forEachChunk(node->right.get(), visit);
+    }
+
+    NodePtr root_;
+};
+
+// Time construction, copy, append and indexing against std::string
+template <typename Str>
+void benchmarkString(const char* label, size_t iterations) {
+    using Clock = std::chrono::steady_clock;
+    auto nsPerOp = [](Clock::time_point start, size_t ops) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(ops);
+    };
+    // Read through volatile so the compiler cannot fold the work away
+    const char* volatile shortText = "config.key";
+    const char* volatile longText = "a label long enough to need a heap buffer of its own";
+    size_t sink = 0;
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        Str s(shortText);
+        sink += s.size();
+    }
+    double constructShort = nsPerOp(start, iterations);
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        Str s(longText);
+        sink += s.size();
+    }
+    double constructLong = nsPerOp(start, iterations);
+
+    Str shortSource(shortText), longSource(longText);
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        Str copy(i % 2 ? shortSource : longSource);
+        sink += copy.size();
+    }
+    double copy = nsPerOp(start, iterations);
+
+    const size_t appends = iterations * 10;
+    Str built;
+    start = Clock::now();
+    for (size_t i = 0; i < appends; ++i) built += shortSource;
+    double appendString = nsPerOp(start, appends);
+    Str chars;
+    start = Clock::now();
+    for (size_t i = 0; i < appends; ++i) chars += static_cast<char>('a' + i % 26);
+    double appendChar = nsPerOp(start, appends);
+
+    start = Clock::now();
+    for (size_t i = 0; i < built.size(); ++i) sink += static_cast<unsigned char>(built[i]);
+    double index = nsPerOp(start, built.size());
+
+    // Eight operands: std::string builds a partial result per '+'
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        Str line = longSource + ": " + shortSource + " = " + longSource + "; " + shortSource + "\n";
+        sink += line.size();
+    }
+    double chain = nsPerOp(start, iterations);
+
+    std::cout << label << "  construct short " << constructShort << "  long " << constructLong
+              << "  copy " << copy << "  append " << appendString << "  push " << appendChar
+              << "  index " << index << "  chain " << chain << " ns/op (" << sink % 10 << ")" << std::endl;
+}
+
+// Time inserts at random positions in a document of size bytes, and
+// substrings of an eighth of it, in MyRope and in std::string
+inline void benchmarkRope(size_t size, size_t inserts) {
+    using Clock = std::chrono::steady_clock;
+    auto usPerOp = [](Clock::time_point start, size_t ops) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / static_cast<double>(ops);
+    };
+    std::string text(size, 'x');
+    for (size_t i = 0; i < size; ++i) text[i] = static_cast<char>('a' + i * 7 % 26);
+    const char* word = "inserted ";
+    std::mt19937_64 random(42);
+    size_t sink = 0;
+
+    MyRope rope(text.data(), text.size());
+    auto start = Clock::now();
+    for (size_t i = 0; i < inserts; ++i) rope.insert(random() % (rope.size() + 1), word, 9);
+    double ropeInsert = usPerOp(start, inserts);
+    start = Clock::now();
+    const size_t substrSize = size / 8;
+    const size_t substrs = std::max<size_t>(1, inserts / 100);
+    for (size_t i = 0; i < substrs; ++i) {
+        size_t pos = random() % (rope.size() - substrSize);
+        sink += rope.substr(pos, substrSize)[100];
+    }
+    double ropeSubstr = usPerOp(start, substrs);
+    start = Clock::now();
+    sink += rope.str().size();
+    double ropeFlatten = usPerOp(start, 1);
+
+    // Each insert moves half the document on average, so do fewer
+    size_t stringInserts = std::max<size_t>(1, inserts / 100);
+    start = Clock::now();
+    for (size_t i = 0; i < stringInserts; ++i) text.insert(random() % (text.size() + 1), word, 9);
+    double stringInsert = usPerOp(start, stringInserts);
+    start = Clock::now();
+    for (size_t i = 0; i < substrs; ++i) {
+        size_t pos = random() % (text.size() - substrSize);
+        sink += text.substr(pos, substrSize)[100];
+    }
+    double stringSubstr = usPerOp(start, substrs);
+
+    std::cout << size << "-byte document: insert MyRope " << ropeInsert << "  std::string " << stringInsert
+              << " us/op; " << substrSize << "-byte substr MyRope " << ropeSubstr << "  std::string " << stringSubstr
+              << " us/op; MyRope::str() " << ropeFlatten / 1000 << " ms (" << sink % 10 << ")" << std::endl;
+}
+
+// Throughput of each string kernel version this CPU runs, over size bytes
+// of text in which the searches find nothing
+inline void benchmarkKernels(size_t size) {
+    using Clock = std::chrono::steady_clock;
+    std::string text(size, ' ');
+    const char* words = "The Quick brown fox jumps over 13 lazy dogs, 42 times ";
+    size_t wordsSize = std::strlen(words);
+    for (size_t i = 0; i < size; ++i) text[i] = words[i % wordsSize];
+    std::string same = text;
+    const int rounds = 8;
+    size_t sink = 0;
+
+    for (const StringKernels* kernels : stringkernels::available()) {
+        auto gbPerSecond = [&](auto run) {
+            auto start = Clock::now();
+            for (int round = 0; round < rounds; ++round) run();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            return static_cast<double>(size) * rounds / seconds / 1e9;
+        };
+        double find = gbPerSecond([&] { sink += kernels->find(text.data(), size, "lazy cats", 9); });
+        double findFirstOf = gbPerSecond([&] { sink += kernels->findFirstOf(text.data(), size, "!?;:", 4); });
+        double compare = gbPerSecond([&] { sink += kernels->compare(text.data(), size, same.data(), size); });
+        double toLower = gbPerSecond([&] { kernels->toLower(&text[0], size); });
+        double toUpper = gbPerSecond([&] { kernels->toUpper(&text[0], size); });
+        double count = gbPerSecond([&] { sink += kernels->countClasses(text.data(), size).vowels; });
+        std::cout << kernels->name << "\tfind " << find << "  find_first_of " << findFirstOf << "  compare " << compare
+                  << "  to_lower " << toLower << "  to_upper " << toUpper << "  count " << count << " GB/s ("
+                  << sink % 10 << ")" << std::endl;
+        same = text; // Still equal after the case round trip
+    }
+}
+
+// Random texts over an alphabet that hits every edge of the character
+// classes, with the kernel versions this CPU runs checked against
+// std::string and against plain loops. Returns false on the first mismatch.
+inline bool checkKernels(size_t rounds) {
+    const char alphabet[] = "aeiouAEIOUbxzBXZ09@[`{/:\x80\xc3\xff ";
+    std::mt19937_64 random(7);
+    auto randomText = [&](size_t size) {
+        std::string text(size, ' ');
+        for (char& c : text) c = alphabet[random() % (sizeof(alphabet) - 1)];
+        return text;
+    };
+    // Exact-size copies, so a sanitizer build catches reads past the end
+    auto exact = [](const std::string& text) {
+        char* copy = new char[text.size() + 1];
+        std::memcpy(copy, text.data(), text.size() + 1);
+        return std::unique_ptr<char[]>(copy);
+    };
+    std::vector<const StringKernels*> versions = stringkernels::available();
+
+    for (size_t round = 0; round < rounds; ++round) {
+        std::string text = randomText(random() % 300);
+        std::string needle = randomText(random() % 5);
+        if (random() % 2 && !text.empty()) {
+            size_t from = random() % text.size();
+            needle = text.substr(from, random() % 40);
+        }
+        std::string set = randomText(random() % 20);
+        std::string other = text;
+        if (random() % 2 && !other.empty()) other[random() % other.size()] = alphabet[random() % 10];
+        if (random() % 4 == 0) other.resize(random() % (other.size() + 1));
+        auto textCopy = exact(text), needleCopy = exact(needle), setCopy = exact(set), otherCopy = exact(other);
+
+        size_t expectFind = std::min(text.find(needle), text.size());
+        size_t expectFirstOf = set.empty() ? text.size() : std::min(text.find_first_of(set), text.size());
+        int expectCompare = text.compare(other) < 0 ? -1 : text.compare(other) > 0 ? 1 : 0;
+        std::string lower = text, upper = text;
+        CharCounts expectCounts = {0, 0, 0};
+        for (size_t i = 0; i < text.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= 'A' && c <= 'Z') lower[i] = static_cast<char>(c + 32);
+            if (c >= 'a' && c <= 'z') upper[i] = static_cast<char>(c - 32);
+            expectCounts.vowels += std::strchr("aeiouAEIOU", c) != nullptr && c != 0;
+            expectCounts.digits += c >= '0' && c <= '9';
+            expectCounts.alpha += (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        }
+
+        for (const StringKernels* kernels : versions) {
+            int order = kernels->compare(textCopy.get(), text.size(), otherCopy.get(), other.size());
+            CharCounts counts = kernels->countClasses(textCopy.get(), text.size());
+            bool ok = kernels->find(textCopy.get(), text.size(), needleCopy.get(), needle.size()) == expectFind &&
+                      kernels->findFirstOf(textCopy.get(), text.size(), setCopy.get(), set.size()) == expectFirstOf &&
+                      (order > 0) - (order < 0) == expectCompare && counts.vowels == expectCounts.vowels &&
+                      counts.digits == expectCounts.digits && counts.alpha == expectCounts.alpha;
+            auto converted = exact(text);
+            kernels->toLower(converted.get(), text.size());
+            ok = ok && lower.compare(0, lower.size(), converted.get(), text.size()) == 0;
+            kernels->toUpper(converted.get(), text.size());
+            ok = ok && std::memcmp(converted.get(), upper.data(), text.size()) == 0;
+            if (!ok) {
+                std::cout << kernels->name << " kernels disagree on a text of " << text.size() << " bytes" << std::endl;
+                return false;
+            }
+        }
+
+        // MyString's wrappers and their positions
+        MyString str(text.data(), text.size());
+        size_t pos = random() % (text.size() + 2);
+        size_t found = str.find(needle.c_str(), needle.size(), pos);
+        size_t foundOf = str.find_first_of(set.c_str(), set.size(), pos);
+        if (found != (pos > text.size() ? MyString::npos : text.find(needle, pos)) ||
+            foundOf != (set.empty() ? MyString::npos : text.find_first_of(set, pos))) {
+            std::cout << "MyString::find disagrees with std::string" << std::endl;
+            return false;
+        }
+    }
+    std::cout << rounds << " rounds agree on";
+    for (const StringKernels* kernels : versions) std::cout << " " << kernels->name;
+    std::cout << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        size_t iterations = argc > 2 ? std::stoul(argv[2]) : 1000000;
+        benchmarkString<std::string>("std::string", iterations);
+        benchmarkString<MyString>("MyString   ", iterations);
+        benchmarkRope(8 << 20, 100000);
+        benchmarkKernels(16 << 20);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--check") {
+        return checkKernels(argc > 2 ? std::stoul(argv[2]) : 100000) ? 0 : 1;
+    }
+
     MyString s1("Hello");
     MyString s2(" World");
     MyString s3 = s1 + s2;
 
     s3.print(); // Output: Hello World
+    std::cout << std::endl;
+
+    s3 += "!";
+    std::cout << s3 << " (" << s3.size() << " characters, " << s3[0] << " first)" << std::endl;
 
     return 0;
 }
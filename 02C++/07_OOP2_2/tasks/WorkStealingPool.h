@@ -0,0 +1,162 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool where every worker owns a task deque.
+//
+// A worker pops its own newest task first (good locality for tasks it just
+// spawned) and, when it runs dry, steals the oldest task of another worker.
+// Tasks may submit more tasks; wait() returns once all of them have run.
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t threads = std::thread::hardware_concurrency())
+        : pending_(0), queued_(0), next_(0), stopping_(false) {
+        if (threads == 0) threads = 1;
+        for (size_t i = 0; i < threads; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    // Index of the calling worker, or -1 outside the pool
+    static int currentWorker() { return workerIndex(); }
+
+    // Queue a task; from inside a task it goes to the calling worker's own deque
+    void submit(std::function<void()> task) {
+        int self = workerIndex();
+        size_t target = self >= 0 && owner() == this
+            ? static_cast<size_t>(self)
+            : next_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        {
+            // Counted before it is pushed so the count never drops below zero
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            queued_.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+            queues_[target]->tasks.push_back(std::move(task));
+        }
+        wake_.notify_one();
+    }
+
+    // Block until every submitted task has finished. Not callable from a task.
+    void wait() {
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        idle_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+
+    // Run body(begin, end) over [0, count) split into chunks, and wait
+    template <typename Body>
+    void parallelFor(size_t count, Body body) {
+        if (count == 0) return;
+        size_t chunks = std::min(count, size() * 8);
+        size_t chunkSize = (count + chunks - 1) / chunks;
+        for (size_t begin = 0; begin < count; begin += chunkSize) {
+            size_t end = std::min(count, begin + chunkSize);
+            submit([&body, begin, end] { body(begin, end); });
+        }
+        wait();
+    }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    static int& workerIndex() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    static WorkStealingPool*& owner() {
+        static thread_local WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    bool popLocal(size_t self, std::function<void()>& task) {
+        Queue& queue = *queues_[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t self, std::function<void()>& task) {
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            Queue& queue = *queues_[(self + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t self) {
+        workerIndex() = static_cast<int>(self);
+        owner() = this;
+        std::function<void()> task;
+        while (true) {
+            if (popLocal(self, task) || steal(self, task)) {
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                task();
+                task = nullptr;
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(sleepMutex_);
+                    idle_.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wake_.wait(lock, [this] { return stopping_ || queued_.load(std::memory_order_relaxed) > 0; });
+            if (stopping_ && queued_.load(std::memory_order_relaxed) == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> pending_; // Submitted and not yet finished
+    std::atomic<size_t> queued_;  // Sitting in a deque
+    std::atomic<size_t> next_;    // Round-robin target for outside submissions
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    bool stopping_;
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -1,24 +1,166 @@
 #include "uart_debugger.h"
-#include <iostream>
-#include <thread>
+#include "uart_frame_decoder.h"
+#include "uart_reactor.h"
+#include "uart_recorder.h"
 #include <chrono>
+#include <iostream>
+#include <random>
+
+// Throughput of each findByte() version over size bytes without the byte,
+// and of each framer decoding a stream of frames of about that size
+static void benchmarkDecoding(size_t size) {
+    using Clock = std::chrono::steady_clock;
+    auto gbPerSecond = [](size_t bytes, Clock::time_point start) {
+        return static_cast<double>(bytes) / std::chrono::duration<double>(Clock::now() - start).count() / 1e9;
+    };
+    const int rounds = 8;
+
+    std::string text(size, 'x');
+    size_t misses = 0; // Results are checked so the timed calls are not optimized away
+    for (const FindByteVersion& version : findByteVersions()) {
+        auto start = Clock::now();
+        for (int round = 0; round < rounds; ++round) misses += version.find(text.data(), text.size(), '\n') != size;
+        std::cout << "findByte " << version.name << ": " << gbPerSecond(rounds * size, start) << " GB/s" << std::endl;
+    }
+
+    // Random 200-byte payloads, encoded for each framer until size is reached
+    std::mt19937 random(3);
+    auto payload = [&](bool printable) {
+        std::string bytes(200, '\0');
+        for (char& c : bytes) c = static_cast<char>(printable ? ' ' + random() % 95 : random() % 256);
+        return bytes;
+    };
+    auto newline = [&] { return payload(true) + "\r\n"; };
+    auto slip = [&] {
+        std::string frame;
+        for (char c : payload(false)) {
+            if (c == static_cast<char>(0xC0)) frame += "\xDB\xDC";
+            else if (c == static_cast<char>(0xDB)) frame += "\xDB\xDD";
+            else frame += c;
+        }
+        return frame + "\xC0";
+    };
+    auto cobs = [&] {
+        std::string bytes = payload(false), frame(1, '\0');
+        size_t code = 0; // Position of the current block's code byte
+        for (char c : bytes) {
+            if (c != '\0') frame += c;
+            if (c == '\0' || frame.size() - code == 0xFF) {
+                frame[code] = static_cast<char>(frame.size() - code);
+                code = frame.size();
+                frame += '\0';
+            }
+        }
+        frame[code] = static_cast<char>(frame.size() - code);
+        return frame + '\0';
+    };
+    auto lengthPrefixed = [&] { return std::string("\x00\xC8", 2) + payload(false); };
 
-int main() {
-    UARTDebugger uart("/dev/ttyS0", B9600); // Adjust device and baud rate as necessary
+    struct Scheme {
+        const char* name;
+        std::function<std::unique_ptr<Framer>()> make;
+        std::function<std::string()> encode;
+    };
+    Scheme schemes[] = {
+        {"newline", [] { return std::make_unique<NewlineFramer>(); }, newline},
+        {"slip", [] { return std::make_unique<SlipFramer>(); }, slip},
+        {"cobs", [] { return std::make_unique<CobsFramer>(); }, cobs},
+        {"length-prefixed", [] { return std::make_unique<LengthPrefixedFramer>(); }, lengthPrefixed},
+    };
+    for (Scheme& scheme : schemes) {
+        std::string stream;
+        size_t expected = 0;
+        while (stream.size() < size) {
+            stream += scheme.encode();
+            ++expected;
+        }
+        uint64_t bytes = 0;
+        FrameDecoder decoder(scheme.make(), [&bytes](std::string_view frame) { bytes += frame.size(); });
+        auto start = Clock::now();
+        for (int round = 0; round < rounds; ++round) misses += decoder.decode(stream) != stream.size();
+        double speed = gbPerSecond(rounds * stream.size(), start);
+        std::cout << scheme.name << " framer: " << speed << " GB/s, " << decoder.frames() / rounds << " of "
+                  << expected << " frames, " << decoder.errors() << " errors" << std::endl;
+    }
+    if (misses != 0) std::cerr << misses << " runs returned a wrong position" << std::endl;
+}
+
+// Write what a capture received into uart's port, spaced out as it arrived
+static bool replayCapture(const std::string& path, UARTDebugger& uart) {
+    UARTReplayer replayer;
+    if (!replayer.open(path) || !uart.open()) return false;
+    long long bytes = replayer.replay(uart.fd(), true);
+    if (bytes < 0) return false;
+    std::cout << "Replayed " << bytes << " bytes from " << path << " into " << uart.device() << std::endl;
+    return true;
+}
+
+// main [device]                    send a message and wait for the answer
+// main --record <capture> [device] the same, capturing both directions
+// main --replay <capture> [device] play a capture's received bytes into
+//                                  device, e.g. one end of a pty pair
+// main --bench [MiB]               decoding throughput
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        size_t mib = argc > 2 ? std::stoul(argv[2]) : 64;
+        benchmarkDecoding(mib << 20);
+        return 0;
+    }
 
-    if (!uart.open()) {
+    std::string mode = argc > 2 ? argv[1] : "";
+    std::string capture;
+    int deviceArg = 1;
+    if (mode == "--record" || mode == "--replay") {
+        capture = argv[2];
+        deviceArg = 3;
+    }
+
+    // Adjust device and baud rate as necessary (a pty slave such as /dev/pts/3 works too)
+    const char* device = argc > deviceArg ? argv[deviceArg] : "/dev/ttyS0";
+    UARTRecorder recorder; // Outlives uart, which records into it
+    UARTDebugger uart(device, B9600);
+    if (mode == "--replay") {
+        return replayCapture(capture, uart) ? 0 : 1;
+    }
+    if (mode == "--record") {
+        if (!recorder.open(capture)) return 1;
+        uart.setRecorder(&recorder);
+    }
+
+    if (!uart.open(true)) {
         std::cerr << "Failed to open UART port" << std::endl;
         return 1;
     }
 
-    std::string message = "Hello UART";
-    if (!uart.send(message)) {
-        std::cerr << "Failed to send message" << std::endl;
+    UARTReactor reactor;
+    if (!reactor.add(uart)) {
+        std::cerr << "Failed to register UART port" << std::endl;
+        return 1;
     }
 
-    std::this_thread::sleep_for(std::chrono::seconds(1)); // Wait for the receiver to process
+    std::string response;
+    uart.onRead([&](UARTDebugger& port) {
+        std::string_view data = port.peek();
+        response.append(data.data(), data.size());
+        port.consume(data.size());
+        reactor.stop();
+    });
+    uart.onClose([&](UARTDebugger& port) {
+        std::cerr << port.device() << " hung up" << std::endl;
+        reactor.stop();
+    });
+
+    std::string message = "Hello UART";
+    uart.asyncSend(message, [](bool ok) {
+        if (!ok) {
+            std::cerr << "Failed to send message" << std::endl;
+        }
+    });
+
+    // Wait for the receiver instead of sleeping a fixed amount of time
+    const int timeoutMs = 1000;
+    while (response.empty() && uart.isOpen() && reactor.runOnce(timeoutMs) > 0) {}
 
-    std::string response = uart.receive();
     if (!response.empty()) {
         std::cout << "Received: " << response << std::endl;
     } else {
@@ -26,5 +168,10 @@ int main() {
     }
 
     uart.close();
+    if (recorder.isOpen()) {
+        recorder.close();
+        std::cout << "Captured " << recorder.records() << " records (" << recorder.bytes() << " bytes) in "
+                  << capture << std::endl;
+    }
     return 0;
 }
@@ -1,19 +1,25 @@
 #include "uart_debugger.h"
+#include "uart_reactor.h"
+#include "uart_recorder.h"
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <iostream>
 #include <cstring>
 #include <cerrno>
 
-UARTDebugger::UARTDebugger(const std::string& device, speed_t baudRate)
-    : device_(device), baudRate_(baudRate), fd_(-1) {}
+UARTDebugger::UARTDebugger(const std::string& device, speed_t baudRate, size_t rxCapacity)
+    : device_(device), baudRate_(baudRate), fd_(-1), nonBlocking_(false), reactor_(nullptr),
+      rxBuffer_(rxCapacity), readPaused_(false), recorder_(nullptr) {}
 
 UARTDebugger::~UARTDebugger() {
     close();
 }
 
-bool UARTDebugger::open() {
-    fd_ = ::open(device_.c_str(), O_RDWR | O_NOCTTY | O_SYNC);
+bool UARTDebugger::open(bool nonBlocking) {
+    nonBlocking_ = nonBlocking;
+    int flags = O_RDWR | O_NOCTTY | (nonBlocking ? O_NONBLOCK : O_SYNC);
+    fd_ = ::open(device_.c_str(), flags);
     if (fd_ < 0) {
         std::cerr << "Error opening UART: " << strerror(errno) << std::endl;
         return false;
@@ -23,10 +29,16 @@ bool UARTDebugger::open() {
 }
 
 void UARTDebugger::close() {
+    if (reactor_ != nullptr) {
+        reactor_->remove(*this);
+    }
     if (fd_ >= 0) {
         ::close(fd_);
         fd_ = -1;
     }
+    // Only now, so a completion callback that resends is refused by asyncSend()
+    // instead of queuing onto a port that is about to go away
+    txQueue_.failAll();
 }
 
 void UARTDebugger::configurePort() {
@@ -42,8 +54,11 @@ void UARTDebugger::configurePort() {
     tty.c_iflag &= ~IGNBRK;
     tty.c_lflag = 0;
     tty.c_oflag = 0;
-    tty.c_cc[VMIN]  = 0;
-    tty.c_cc[VTIME] = 5;
+    // In reactor mode epoll does the waiting. VMIN = 1 makes an empty
+    // non-blocking read fail with EAGAIN, so a read of 0 bytes means the other
+    // side hung up (with VMIN = VTIME = 0 it would also mean "no data yet").
+    tty.c_cc[VMIN]  = nonBlocking_ ? 1 : 0;
+    tty.c_cc[VTIME] = nonBlocking_ ? 0 : 5;
 
     if (tcsetattr(fd_, TCSANOW, &tty) != 0) {
         std::cerr << "Error setting UART attributes: " << strerror(errno) << std::endl;
@@ -51,17 +66,129 @@ void UARTDebugger::configurePort() {
 }
 
 bool UARTDebugger::send(const std::string& message) {
-    if (fd_ < 0) return false;
-    return ::write(fd_, message.c_str(), message.size()) == static_cast<ssize_t>(message.size());
+    return queue(message) && flush();
+}
+
+bool UARTDebugger::queue(const std::string& message) {
+    return asyncSend(message);
+}
+
+bool UARTDebugger::flush() {
+    while (fd_ >= 0 && !txQueue_.empty()) {
+        if (!flushTxQueue()) return false;
+        if (txQueue_.empty()) break;
+
+        // Non-blocking fd is out of room: wait until it drains
+        pollfd pfd{fd_, POLLOUT, 0};
+        if (::poll(&pfd, 1, -1) < 0 && errno != EINTR) return false;
+    }
+    return fd_ >= 0;
+}
+
+bool UARTDebugger::flushTxQueue() {
+    // Tx is captured as the port accepts it, so failed or dropped messages never show up as sent
+    UARTTxQueue::WrittenCallback capture;
+    if (recorder_ != nullptr) {
+        capture = [this](std::string_view data) { recorder_->record(LogDirection::Tx, data); };
+    }
+    if (txQueue_.flush(fd_, capture)) return true;
+
+    std::cerr << "Error writing UART " << device_ << ": " << strerror(errno) << std::endl;
+    txQueue_.failAll();
+    return false;
 }
 
 std::string UARTDebugger::receive() {
     if (fd_ < 0) return "";
-    char buf[256];
-    ssize_t n = ::read(fd_, buf, sizeof(buf) - 1);
-    if (n > 0) {
-        buf[n] = '\0';
-        return std::string(buf);
+    fill();
+
+    // Copy out by length, so 0x00 bytes are kept
+    std::string_view parts[2];
+    size_t count = rxBuffer_.peek(parts);
+    std::string result;
+    result.reserve(rxBuffer_.size());
+    for (size_t i = 0; i < count; ++i) {
+        result.append(parts[i].data(), parts[i].size());
+    }
+    consume(result.size());
+    return result;
+}
+
+ssize_t UARTDebugger::fill() {
+    if (fd_ < 0) return -1;
+    std::string_view filled[2];
+    ssize_t n;
+    do {
+        n = rxBuffer_.readFrom(fd_, filled);
+    } while (n < 0 && errno == EINTR);
+
+    if (n > 0 && recorder_ != nullptr) {
+        recorder_->record(LogDirection::Rx, filled[0], filled[1]);
+    }
+    return n;
+}
+
+void UARTDebugger::consume(size_t n) {
+    rxBuffer_.consume(n);
+    if (readPaused_ && reactor_ != nullptr && wantsRead()) {
+        readPaused_ = false;
+        reactor_->updateInterest(*this);
+    }
+}
+
+void UARTDebugger::onRead(ReadCallback callback) {
+    readCallback_ = std::move(callback);
+}
+
+void UARTDebugger::onClose(CloseCallback callback) {
+    closeCallback_ = std::move(callback);
+}
+
+bool UARTDebugger::asyncSend(const std::string& message, WriteCallback done) {
+    if (fd_ < 0) return false;
+    bool wasEmpty = txQueue_.empty();
+    if (!txQueue_.push(message, std::move(done))) return false; // Above high-water mark
+    if (reactor_ != nullptr && wasEmpty) {
+        reactor_->updateInterest(*this);
+    }
+    return true;
+}
+
+void UARTDebugger::handleReadable() {
+    while (fd_ >= 0 && !rxBuffer_.full()) {
+        ssize_t n = fill();
+        if (n > 0) {
+            if (readCallback_) readCallback_(*this);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return; // Drained
+        }
+
+        // End of stream, or EIO after a hangup (e.g. the other side of a pty
+        // went away): epoll would report the fd forever, so give it up
+        if (n < 0) {
+            std::cerr << "Error reading UART " << device_ << ": " << strerror(errno) << std::endl;
+        }
+        handleHangup();
+        return;
+    }
+
+    // The consumer left the ring full: stop polling for input until it consume()s
+    if (fd_ >= 0 && reactor_ != nullptr && !readPaused_) {
+        readPaused_ = true;
+        reactor_->updateInterest(*this);
+    }
+}
+
+void UARTDebugger::handleHangup() {
+    close(); // Also removes the port from the reactor
+    if (closeCallback_) closeCallback_(*this);
+}
+
+void UARTDebugger::handleWritable() {
+    flushTxQueue();
+    if (reactor_ != nullptr && txQueue_.empty()) {
+        reactor_->updateInterest(*this);
     }
-    return "";
 }
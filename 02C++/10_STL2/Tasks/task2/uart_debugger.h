@@ -1,25 +1,96 @@
 #ifndef UART_DEBUGGER_H
 #define UART_DEBUGGER_H
 
+#include "uart_ring_buffer.h"
+#include "uart_tx_queue.h"
 #include <termios.h>
 #include <string>
+#include <string_view>
+#include <functional>
+
+class UARTReactor;
+class UARTRecorder;
 
 class UARTDebugger {
 public:
-    UARTDebugger(const std::string& device, speed_t baudRate);
+    // Completion callbacks used in reactor mode. A read callback looks at the
+    // received bytes with peek() and consume()s what it used; the rest is kept
+    // in the receive ring for the next call.
+    using ReadCallback = std::function<void(UARTDebugger& uart)>;
+    using WriteCallback = UARTTxQueue::WriteCallback;
+    // Called once the port has been closed because the other side hung up or
+    // reading failed. The port must not be destroyed from inside the callback.
+    using CloseCallback = std::function<void(UARTDebugger& uart)>;
+
+    UARTDebugger(const std::string& device, speed_t baudRate, size_t rxCapacity = 64 * 1024);
     ~UARTDebugger();
 
-    bool open();
+    // nonBlocking = true opens the port with O_NONBLOCK for use with a UARTReactor
+    bool open(bool nonBlocking = false);
     void close();
+    // Blocking send; retries partial writes until the whole message is out
     bool send(const std::string& message);
     std::string receive();
 
+    // Blocking batch send: queue() several messages, then flush() them with as
+    // few writev() calls as possible
+    bool queue(const std::string& message);
+    bool flush();
+
+    // Allocation-free receive path: readv() into the receive ring, then look at
+    // the bytes with peek() and release them with consume(n). In reactor mode
+    // consume() must be called from the reactor thread.
+    ssize_t fill();
+    std::string_view peek() const { return rxBuffer_.peek(); }
+    void consume(size_t n);
+    UARTRingBuffer& rxBuffer() { return rxBuffer_; }
+
+    // Reactor mode: data is delivered to onRead whenever the port becomes readable
+    void onRead(ReadCallback callback);
+    // Reactor mode: told when end of stream or a read error closes the port
+    void onClose(CloseCallback callback);
+    // Reactor mode: queue a message, done is called once it is fully written (or failed).
+    // Returns false without queuing when the transmit queue is above its high-water mark.
+    bool asyncSend(const std::string& message, WriteCallback done = nullptr);
+
+    void setTxHighWaterMark(size_t bytes) { txQueue_.setHighWaterMark(bytes); }
+    size_t txPendingBytes() const { return txQueue_.pendingBytes(); }
+    const UARTTxQueue::Stats& txStats() const { return txQueue_.stats(); }
+
+    // Capture every received chunk and every chunk written out (nullptr stops capturing)
+    void setRecorder(UARTRecorder* recorder) { recorder_ = recorder; }
+
+    int fd() const { return fd_; }
+    bool isOpen() const { return fd_ >= 0; }
+    const std::string& device() const { return device_; }
+
 private:
+    friend class UARTReactor;
+
     std::string device_;
     speed_t baudRate_;
     int fd_; // File descriptor for the UART port
+    bool nonBlocking_;
+
+    UARTReactor* reactor_; // Event loop this port is registered with, if any
+    ReadCallback readCallback_;
+    CloseCallback closeCallback_;
+    UARTTxQueue txQueue_; // Outbound messages not yet written
+
+    UARTRingBuffer rxBuffer_; // Persistent receive buffer, reused for every read
+    bool readPaused_; // EPOLLIN is dropped while rxBuffer_ is full
+
+    UARTRecorder* recorder_;
 
     void configurePort();
+
+    // Called by the reactor when the fd is ready
+    void handleReadable();
+    void handleWritable();
+    void handleHangup();
+    bool flushTxQueue();
+    bool wantsRead() const { return !rxBuffer_.full(); }
+    bool wantsWrite() const { return !txQueue_.empty(); }
 };
 
 #endif // UART_DEBUGGER_H
@@ -0,0 +1,237 @@
+#include "uart_frame_decoder.h"
+#include "uart_debugger.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define UART_HAVE_X86_SIMD 1
+#endif
+
+namespace {
+
+size_t findByteScalar(const char* data, size_t size, char c) {
+    const void* p = std::memchr(data, c, size);
+    return p ? static_cast<size_t>(static_cast<const char*>(p) - data) : size;
+}
+
+#ifdef UART_HAVE_X86_SIMD
+__attribute__((target("sse2")))
+size_t findByteSse2(const char* data, size_t size, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask != 0) return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+    for (; i < size; ++i) {
+        if (data[i] == c) return i;
+    }
+    return size;
+}
+
+__attribute__((target("avx2")))
+size_t findByteAvx2(const char* data, size_t size, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t i = 0;
+    // Two vectors per iteration to keep both load ports busy
+    for (; i + 64 <= size; i += 64) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        __m256i eqA = _mm256_cmpeq_epi8(a, needle);
+        __m256i eqB = _mm256_cmpeq_epi8(b, needle);
+        if (!_mm256_testz_si256(_mm256_or_si256(eqA, eqB), _mm256_or_si256(eqA, eqB))) {
+            unsigned maskA = static_cast<unsigned>(_mm256_movemask_epi8(eqA));
+            if (maskA != 0) return i + static_cast<size_t>(__builtin_ctz(maskA));
+            unsigned maskB = static_cast<unsigned>(_mm256_movemask_epi8(eqB));
+            return i + 32 + static_cast<size_t>(__builtin_ctz(maskB));
+        }
+    }
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+        if (mask != 0) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+    for (; i < size; ++i) {
+        if (data[i] == c) return i;
+    }
+    return size;
+}
+#endif
+
+using FindByteFn = size_t (*)(const char*, size_t, char);
+
+FindByteFn selectFindByte() {
+#ifdef UART_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return findByteAvx2;
+    if (__builtin_cpu_supports("sse2")) return findByteSse2;
+#endif
+    return findByteScalar;
+}
+
+const FindByteFn findByteImpl = selectFindByte();
+
+const char kSlipEnd = static_cast<char>(0xC0);
+const char kSlipEsc = static_cast<char>(0xDB);
+const char kSlipEscEnd = static_cast<char>(0xDC);
+const char kSlipEscEsc = static_cast<char>(0xDD);
+
+} // namespace
+
+size_t findByte(const char* data, size_t size, char c) {
+    return findByteImpl(data, size, c);
+}
+
+std::vector<FindByteVersion> findByteVersions() {
+    std::vector<FindByteVersion> versions = {{"scalar", findByteScalar}};
+#ifdef UART_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) versions.push_back({"sse2", findByteSse2});
+    if (__builtin_cpu_supports("avx2")) versions.push_back({"avx2", findByteAvx2});
+#endif
+    return versions;
+}
+
+Framer::Status NewlineFramer::next(std::string_view in, std::string_view& frame, size_t& consumed) {
+    size_t pos = findByte(in.data(), in.size(), '\n');
+    if (pos == in.size()) return Status::NeedMore;
+
+    consumed = pos + 1;
+    size_t len = (pos > 0 && in[pos - 1] == '\r') ? pos - 1 : pos;
+    frame = in.substr(0, len);
+    return Status::Frame;
+}
+
+Framer::Status SlipFramer::next(std::string_view in, std::string_view& frame, size_t& consumed) {
+    size_t pos = findByte(in.data(), in.size(), kSlipEnd);
+    if (pos == in.size()) return Status::NeedMore;
+
+    consumed = pos + 1;
+    if (pos == 0) return Status::Skip; // Leading END used to flush line noise
+
+    size_t esc = findByte(in.data(), pos, kSlipEsc);
+    if (esc == pos) {
+        frame = in.substr(0, pos); // Nothing escaped: hand out the bytes in place
+        return Status::Frame;
+    }
+
+    scratch_.assign(in.data(), esc);
+    for (size_t i = esc; i < pos; ++i) {
+        if (in[i] != kSlipEsc) {
+            scratch_.push_back(in[i]);
+            continue;
+        }
+        if (++i == pos) return Status::Error;
+        if (in[i] == kSlipEscEnd) scratch_.push_back(kSlipEnd);
+        else if (in[i] == kSlipEscEsc) scratch_.push_back(kSlipEsc);
+        else return Status::Error;
+    }
+    frame = scratch_;
+    return Status::Frame;
+}
+
+Framer::Status CobsFramer::next(std::string_view in, std::string_view& frame, size_t& consumed) {
+    size_t pos = findByte(in.data(), in.size(), '\0');
+    if (pos == in.size()) return Status::NeedMore;
+
+    consumed = pos + 1;
+    if (pos == 0) return Status::Skip;
+
+    scratch_.clear();
+    size_t i = 0;
+    while (i < pos) {
+        size_t code = static_cast<unsigned char>(in[i]);
+        if (i + code > pos) return Status::Error;
+        scratch_.append(in.data() + i + 1, code - 1);
+        i += code;
+        // A code of 0xFF means a full block without an implied zero
+        if (code != 0xFF && i < pos) scratch_.push_back('\0');
+    }
+    frame = scratch_;
+    return Status::Frame;
+}
+
+Framer::Status LengthPrefixedFramer::next(std::string_view in, std::string_view& frame, size_t& consumed) {
+    if (in.size() < 2) return Status::NeedMore;
+
+    size_t len = (static_cast<size_t>(static_cast<unsigned char>(in[0])) << 8) |
+                 static_cast<unsigned char>(in[1]);
+    if (len > maxFrame_) {
+        consumed = 2; // Bad header: drop it and try to resynchronize on what follows
+        return Status::Error;
+    }
+    if (in.size() < 2 + len) return Status::NeedMore;
+
+    consumed = 2 + len;
+    frame = in.substr(2, len);
+    return Status::Frame;
+}
+
+FrameDecoder::FrameDecoder(std::unique_ptr<Framer> framer, FrameCallback onFrame, size_t maxFrame)
+    : framer_(std::move(framer)), onFrame_(std::move(onFrame)), limit_(2 * maxFrame + 2),
+      frames_(0), errors_(0) {
+    carry_.reserve(limit_ + 1);
+}
+
+Framer::Status FrameDecoder::step(std::string_view in, size_t& consumed) {
+    std::string_view frame;
+    consumed = 0;
+    Framer::Status status = framer_->next(in, frame, consumed);
+
+    switch (status) {
+        case Framer::Status::NeedMore:
+            if (in.size() > limit_) {
+                // No delimiter within the size limit: drop it all
+                consumed = in.size();
+                ++errors_;
+                return Framer::Status::Error;
+            }
+            break;
+        case Framer::Status::Frame:
+            ++frames_;
+            if (onFrame_) onFrame_(frame);
+            break;
+        case Framer::Status::Skip:
+            break;
+        case Framer::Status::Error:
+            ++errors_;
+            break;
+    }
+    return status;
+}
+
+size_t FrameDecoder::decode(std::string_view data) {
+    size_t used = 0;
+    while (used < data.size()) {
+        size_t consumed;
+        if (step(data.substr(used), consumed) == Framer::Status::NeedMore) break;
+        used += consumed;
+    }
+    return used;
+}
+
+void FrameDecoder::feed(UARTDebugger& uart) {
+    UARTRingBuffer& rx = uart.rxBuffer();
+    while (true) {
+        std::string_view parts[2];
+        size_t count = rx.peek(parts);
+        if (count == 0) return;
+
+        size_t used = decode(parts[0]);
+        if (used > 0) {
+            uart.consume(used); // Frames were handed out in place, release them now
+            continue;
+        }
+        if (count < 2) return; // Incomplete frame, wait for more data
+
+        // The next frame straddles the end of the ring: linearize just that frame
+        carry_.assign(parts[0].data(), parts[0].size());
+        size_t more = limit_ + 1 > carry_.size() ? limit_ + 1 - carry_.size() : 0;
+        carry_.append(parts[1].data(), more < parts[1].size() ? more : parts[1].size());
+
+        size_t consumed;
+        if (step(carry_, consumed) == Framer::Status::NeedMore) return;
+        uart.consume(consumed);
+    }
+}
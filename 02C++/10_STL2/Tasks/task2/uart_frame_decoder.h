@@ -0,0 +1,111 @@
+#ifndef UART_FRAME_DECODER_H
+#define UART_FRAME_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class UARTDebugger;
+
+// Position of the first c in [data, data + size), or size if there is none.
+// Uses AVX2 or SSE2 when the CPU has them (picked once at startup).
+size_t findByte(const char* data, size_t size, char c);
+
+// One implementation of findByte(), for benchmarks
+struct FindByteVersion {
+    const char* name;
+    size_t (*find)(const char* data, size_t size, char c);
+};
+
+// The findByte() versions this CPU can run, slowest first
+std::vector<FindByteVersion> findByteVersions();
+
+// A framing scheme: cuts one frame off the front of a byte stream
+class Framer {
+public:
+    enum class Status {
+        NeedMore, // No complete frame yet
+        Frame,    // frame is set and consumed bytes belong to it
+        Skip,     // consumed bytes carry no frame (e.g. empty frame between delimiters)
+        Error     // consumed bytes were a malformed frame and are dropped
+    };
+
+    virtual ~Framer() = default;
+
+    // frame points into in when no unescaping is needed, otherwise into a buffer
+    // owned by the framer; either way it is valid until the next call
+    virtual Status next(std::string_view in, std::string_view& frame, size_t& consumed) = 0;
+};
+
+// Frames end with '\n'; a trailing '\r' is stripped
+class NewlineFramer : public Framer {
+public:
+    Status next(std::string_view in, std::string_view& frame, size_t& consumed) override;
+};
+
+// RFC 1055 SLIP: frames end with 0xC0, escapes are only decoded when present
+class SlipFramer : public Framer {
+public:
+    Status next(std::string_view in, std::string_view& frame, size_t& consumed) override;
+
+private:
+    std::string scratch_;
+};
+
+// Consistent Overhead Byte Stuffing, frames end with 0x00
+class CobsFramer : public Framer {
+public:
+    Status next(std::string_view in, std::string_view& frame, size_t& consumed) override;
+
+private:
+    std::string scratch_;
+};
+
+// 16-bit big-endian length followed by the payload
+class LengthPrefixedFramer : public Framer {
+public:
+    explicit LengthPrefixedFramer(size_t maxFrame = 4096) : maxFrame_(maxFrame) {}
+    Status next(std::string_view in, std::string_view& frame, size_t& consumed) override;
+
+private:
+    size_t maxFrame_;
+};
+
+// Streaming decoder: runs a Framer over incoming bytes and hands each frame to a
+// callback without copying it out of the receive buffer. Only a frame that
+// straddles the receive ring's wrap point is copied into a reusable carry buffer.
+class FrameDecoder {
+public:
+    // frame is only valid for the duration of the call
+    using FrameCallback = std::function<void(std::string_view frame)>;
+
+    // maxFrame bounds a decoded frame; the UART receive ring must be larger
+    // than 2 * maxFrame + 2 so a worst-case escaped frame always fits
+    FrameDecoder(std::unique_ptr<Framer> framer, FrameCallback onFrame, size_t maxFrame = 4096);
+
+    // Decode all complete frames in data; returns the number of bytes used.
+    // The unused tail is the start of an incomplete frame.
+    size_t decode(std::string_view data);
+
+    // Decode everything available in the debugger's receive ring and consume it
+    void feed(UARTDebugger& uart);
+
+    uint64_t frames() const { return frames_; }
+    uint64_t errors() const { return errors_; }
+
+private:
+    std::unique_ptr<Framer> framer_;
+    FrameCallback onFrame_;
+    size_t limit_; // Longest encoded frame accepted before the data is dropped
+    std::string carry_; // Linearized bytes around the ring's wrap point
+    uint64_t frames_;
+    uint64_t errors_;
+
+    Framer::Status step(std::string_view in, size_t& consumed);
+};
+
+#endif // UART_FRAME_DECODER_H
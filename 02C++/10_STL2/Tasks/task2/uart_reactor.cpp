@@ -0,0 +1,148 @@
+#include "uart_reactor.h"
+#include "uart_debugger.h"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+
+UARTReactor::UARTReactor()
+    : epollFd_(-1), wakeFd_(-1), running_(false), eventCount_(0) {
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        std::cerr << "Error creating epoll instance: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        std::cerr << "Error creating eventfd: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr; // nullptr marks the wake-up fd
+    ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+}
+
+UARTReactor::~UARTReactor() {
+    while (!ports_.empty()) {
+        remove(**ports_.begin());
+    }
+    if (wakeFd_ >= 0) ::close(wakeFd_);
+    if (epollFd_ >= 0) ::close(epollFd_);
+}
+
+bool UARTReactor::add(UARTDebugger& uart) {
+    if (epollFd_ < 0 || uart.fd_ < 0) return false;
+    if (uart.reactor_ != nullptr && uart.reactor_ != this) {
+        uart.reactor_->remove(uart);
+    }
+
+    epoll_event ev{};
+    ev.events = interestFor(uart);
+    ev.data.ptr = &uart;
+    if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, uart.fd_, &ev) != 0) {
+        std::cerr << "Error adding " << uart.device_ << " to reactor: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    uart.reactor_ = this;
+    ports_.insert(&uart);
+    return true;
+}
+
+void UARTReactor::remove(UARTDebugger& uart) {
+    if (uart.reactor_ != this) return;
+
+    if (uart.fd_ >= 0) {
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, uart.fd_, nullptr);
+    }
+    // Drop events for this port that are still waiting in the current batch
+    for (int i = 0; i < eventCount_; ++i) {
+        if (events_[i].data.ptr == &uart) {
+            events_[i].events = 0;
+        }
+    }
+
+    uart.reactor_ = nullptr;
+    ports_.erase(&uart);
+}
+
+uint32_t UARTReactor::interestFor(const UARTDebugger& uart) {
+    uint32_t events = 0;
+    if (uart.wantsRead()) events |= EPOLLIN;
+    if (uart.wantsWrite()) events |= EPOLLOUT;
+    return events;
+}
+
+void UARTReactor::updateInterest(UARTDebugger& uart) {
+    if (uart.fd_ < 0) return;
+
+    epoll_event ev{};
+    ev.events = interestFor(uart);
+    ev.data.ptr = &uart;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, uart.fd_, &ev);
+}
+
+int UARTReactor::runOnce(int timeoutMs) {
+    if (epollFd_ < 0) return -1;
+
+    int n = ::epoll_wait(epollFd_, events_, kMaxEvents, timeoutMs);
+    if (n < 0) {
+        if (errno == EINTR) return 0;
+        std::cerr << "Error waiting for events: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    eventCount_ = n;
+    for (int i = 0; i < eventCount_; ++i) {
+        uint32_t events = events_[i].events;
+        if (events == 0) continue; // Port removed earlier in this batch
+
+        if (events_[i].data.ptr == nullptr) {
+            uint64_t value;
+            while (::read(wakeFd_, &value, sizeof(value)) > 0) {}
+            continue;
+        }
+
+        UARTDebugger* uart = static_cast<UARTDebugger*>(events_[i].data.ptr);
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            // Reported even while reading is paused (no EPOLLIN in the mask).
+            // A readable port is drained first and closes at end of stream; a
+            // paused one would be reported again on every wait, so it is
+            // closed now, keeping what its ring already holds.
+            if (uart->wantsRead()) {
+                uart->handleReadable();
+            } else {
+                uart->handleHangup();
+            }
+        } else if ((events & EPOLLIN) && uart->wantsRead()) {
+            uart->handleReadable();
+        }
+        // handleReadable() may have closed or removed the port
+        if ((events_[i].events & EPOLLOUT) && uart->reactor_ == this) {
+            uart->handleWritable();
+        }
+    }
+    eventCount_ = 0;
+    return n;
+}
+
+void UARTReactor::run() {
+    running_ = true;
+    while (running_) {
+        if (runOnce(-1) < 0) break;
+    }
+}
+
+void UARTReactor::stop() {
+    running_ = false;
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
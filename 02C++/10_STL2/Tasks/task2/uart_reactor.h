@@ -0,0 +1,50 @@
+#ifndef UART_REACTOR_H
+#define UART_REACTOR_H
+
+#include <sys/epoll.h>
+#include <atomic>
+#include <cstdint>
+#include <unordered_set>
+
+class UARTDebugger;
+
+// Single-threaded epoll event loop shared by many UARTDebugger instances.
+// Ports must be opened with open(true) so their fds are non-blocking.
+class UARTReactor {
+public:
+    UARTReactor();
+    ~UARTReactor();
+
+    UARTReactor(const UARTReactor&) = delete;
+    UARTReactor& operator=(const UARTReactor&) = delete;
+
+    bool add(UARTDebugger& uart);
+    void remove(UARTDebugger& uart);
+
+    // Wait up to timeoutMs (-1 = forever) and dispatch ready ports.
+    // Returns the number of events handled, or -1 on error.
+    int runOnce(int timeoutMs);
+    // Dispatch events until stop() is called
+    void run();
+    // Safe to call from any thread or from inside a callback
+    void stop();
+
+private:
+    friend class UARTDebugger;
+
+    static const int kMaxEvents = 64;
+
+    int epollFd_;
+    int wakeFd_; // eventfd used to interrupt epoll_wait on stop()
+    std::atomic<bool> running_;
+    std::unordered_set<UARTDebugger*> ports_;
+
+    // Events of the batch currently being dispatched, so remove() can drop stale entries
+    epoll_event events_[kMaxEvents];
+    int eventCount_;
+
+    static uint32_t interestFor(const UARTDebugger& uart);
+    void updateInterest(UARTDebugger& uart);
+};
+
+#endif // UART_REACTOR_H
@@ -0,0 +1,255 @@
+#include "uart_recorder.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char kLogMagic[8] = {'U', 'A', 'R', 'T', 'L', 'O', 'G', '1'};
+const size_t kAlignment = 4096;
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                pollfd pfd{fd, POLLOUT, 0};
+                ::poll(&pfd, 1, -1);
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+UARTRecorder::UARTRecorder(size_t bufferSize, size_t bufferCount)
+    : bufferSize_((bufferSize + kAlignment - 1) / kAlignment * kAlignment), active_(nullptr), fd_(-1),
+      records_(0), bytes_(0), stopping_(false) {
+    if (bufferCount < 2) bufferCount = 2;
+    for (size_t i = 0; i < bufferCount; ++i) {
+        char* data = static_cast<char*>(std::aligned_alloc(kAlignment, bufferSize_));
+        buffers_.push_back({data, 0});
+    }
+}
+
+UARTRecorder::~UARTRecorder() {
+    close();
+    for (auto& buffer : buffers_) {
+        std::free(buffer.data);
+    }
+}
+
+bool UARTRecorder::open(const std::string& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Error opening capture " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    freeBuffers_.clear();
+    fullBuffers_.clear();
+    for (auto& buffer : buffers_) {
+        buffer.used = 0;
+        freeBuffers_.push_back(&buffer);
+    }
+    active_ = freeBuffers_.front();
+    freeBuffers_.pop_front();
+    records_ = 0;
+    bytes_ = 0;
+    stopping_ = false;
+
+    start_ = std::chrono::steady_clock::now();
+    LogFileHeader header;
+    std::memcpy(header.magic, kLogMagic, sizeof(header.magic));
+    header.startRealtimeNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    writer_ = std::thread(&UARTRecorder::writerLoop, this);
+    return true;
+}
+
+void UARTRecorder::close() {
+    if (fd_ < 0) return;
+
+    if (active_->used > 0) {
+        submitActive();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    writer_.join();
+
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void UARTRecorder::record(LogDirection direction, std::string_view data) {
+    record(direction, data, std::string_view());
+}
+
+void UARTRecorder::record(LogDirection direction, std::string_view first, std::string_view second) {
+    if (fd_ < 0) return;
+
+    LogRecordHeader header{};
+    header.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_).count());
+    header.length = static_cast<uint32_t>(first.size() + second.size());
+    header.direction = static_cast<uint8_t>(direction);
+
+    append(reinterpret_cast<const char*>(&header), sizeof(header));
+    append(first.data(), first.size());
+    append(second.data(), second.size());
+    ++records_;
+    bytes_ += header.length;
+}
+
+void UARTRecorder::append(const char* data, size_t size) {
+    while (size > 0) {
+        size_t room = bufferSize_ - active_->used;
+        size_t chunk = size < room ? size : room;
+        std::memcpy(active_->data + active_->used, data, chunk);
+        active_->used += chunk;
+        data += chunk;
+        size -= chunk;
+        if (active_->used == bufferSize_) {
+            submitActive();
+        }
+    }
+}
+
+void UARTRecorder::submitActive() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    fullBuffers_.push_back(active_);
+    cv_.notify_all();
+    cv_.wait(lock, [this] { return !freeBuffers_.empty(); });
+    active_ = freeBuffers_.front();
+    freeBuffers_.pop_front();
+}
+
+void UARTRecorder::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !fullBuffers_.empty(); });
+        if (fullBuffers_.empty()) return; // stopping_ and nothing left to write
+
+        Buffer* buffer = fullBuffers_.front();
+        fullBuffers_.pop_front();
+        lock.unlock();
+
+        if (!writeAll(fd_, buffer->data, buffer->used)) {
+            std::cerr << "Error writing capture: " << strerror(errno) << std::endl;
+        }
+        buffer->used = 0;
+
+        lock.lock();
+        freeBuffers_.push_back(buffer);
+        cv_.notify_all();
+    }
+}
+
+UARTReplayer::UARTReplayer() : data_(nullptr), size_(0) {}
+
+UARTReplayer::~UARTReplayer() {
+    close();
+}
+
+bool UARTReplayer::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Error opening capture " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(LogFileHeader)) {
+        std::cerr << "Capture " << path << " is too short" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "Error mapping capture " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    ::madvise(map, size, MADV_SEQUENTIAL);
+
+    if (std::memcmp(map, kLogMagic, sizeof(kLogMagic)) != 0) {
+        std::cerr << path << " is not a UART capture" << std::endl;
+        ::munmap(map, size);
+        return false;
+    }
+
+    data_ = static_cast<const char*>(map);
+    size_ = size;
+    return true;
+}
+
+void UARTReplayer::close() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+uint64_t UARTReplayer::startRealtimeNs() const {
+    if (data_ == nullptr) return 0;
+    LogFileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    return header.startRealtimeNs;
+}
+
+void UARTReplayer::forEach(const std::function<void(const LogRecordHeader& header, std::string_view payload)>& visit) const {
+    if (data_ == nullptr) return;
+
+    size_t offset = sizeof(LogFileHeader);
+    while (offset + sizeof(LogRecordHeader) <= size_) {
+        LogRecordHeader header;
+        std::memcpy(&header, data_ + offset, sizeof(header));
+        offset += sizeof(header);
+        if (header.length > size_ - offset) break; // Truncated tail of an interrupted capture
+
+        visit(header, std::string_view(data_ + offset, header.length));
+        offset += header.length;
+    }
+}
+
+long long UARTReplayer::replay(int fd, bool originalTiming, LogDirection direction) const {
+    long long total = 0;
+    bool failed = false;
+    auto start = std::chrono::steady_clock::now();
+
+    forEach([&](const LogRecordHeader& header, std::string_view payload) {
+        if (failed || header.direction != static_cast<uint8_t>(direction)) return;
+        if (originalTiming) {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(header.timestampNs));
+        }
+        if (!writeAll(fd, payload.data(), payload.size())) {
+            std::cerr << "Error replaying capture: " << strerror(errno) << std::endl;
+            failed = true;
+            return;
+        }
+        total += static_cast<long long>(payload.size());
+    });
+    return failed ? -1 : total;
+}
@@ -0,0 +1,114 @@
+#ifndef UART_RECORDER_H
+#define UART_RECORDER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// On-disk capture format:
+//   LogFileHeader, then one LogRecordHeader + payload per record, back to back.
+// All integers are little-endian (host order on the machines we capture on).
+struct LogFileHeader {
+    char magic[8];            // "UARTLOG1"
+    uint64_t startRealtimeNs; // Wall clock at the start of the capture
+};
+
+struct LogRecordHeader {
+    uint64_t timestampNs; // Monotonic time since the start of the capture
+    uint32_t length;      // Payload bytes that follow
+    uint8_t direction;    // LogDirection
+    uint8_t reserved[3];
+};
+
+enum class LogDirection : uint8_t {
+    Rx = 0, // Bytes received from the port
+    Tx = 1  // Bytes sent to the port
+};
+
+// Appends timestamped records to a capture file. record() only copies into a
+// large page-aligned buffer; full buffers are written out by a background thread.
+class UARTRecorder {
+public:
+    explicit UARTRecorder(size_t bufferSize = 1 << 20, size_t bufferCount = 4);
+    ~UARTRecorder();
+
+    UARTRecorder(const UARTRecorder&) = delete;
+    UARTRecorder& operator=(const UARTRecorder&) = delete;
+
+    bool open(const std::string& path);
+    // Flushes everything recorded so far and stops the writer thread
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Call from one thread only (e.g. the reactor thread). Blocks only if every
+    // buffer is still waiting for the writer thread.
+    void record(LogDirection direction, std::string_view data);
+    // A record whose payload arrives in two pieces (e.g. a wrapped ring read)
+    void record(LogDirection direction, std::string_view first, std::string_view second);
+
+    uint64_t records() const { return records_; }
+    uint64_t bytes() const { return bytes_; } // Payload bytes recorded
+
+private:
+    struct Buffer {
+        char* data;
+        size_t used;
+    };
+
+    size_t bufferSize_;
+    std::vector<Buffer> buffers_;
+    Buffer* active_; // Buffer record() is currently filling
+    int fd_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t records_;
+    uint64_t bytes_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Buffer*> freeBuffers_;
+    std::deque<Buffer*> fullBuffers_;
+    bool stopping_;
+    std::thread writer_;
+
+    void append(const char* data, size_t size);
+    void submitActive();
+    void writerLoop();
+};
+
+// Plays a capture back into a fd (typically the master side of a pty).
+// The capture is mmap()ed, so records are written straight from the page cache.
+class UARTReplayer {
+public:
+    UARTReplayer();
+    ~UARTReplayer();
+
+    UARTReplayer(const UARTReplayer&) = delete;
+    UARTReplayer& operator=(const UARTReplayer&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // Write the payload of every record with the given direction to fd, either
+    // spaced out like the original capture or as fast as fd accepts it.
+    // Returns the number of payload bytes written, or -1 on error.
+    long long replay(int fd, bool originalTiming, LogDirection direction = LogDirection::Rx) const;
+
+    // Visit every record in order; payload points into the mapping
+    void forEach(const std::function<void(const LogRecordHeader& header, std::string_view payload)>& visit) const;
+
+    uint64_t startRealtimeNs() const;
+
+private:
+    const char* data_;
+    size_t size_;
+};
+
+#endif // UART_RECORDER_H
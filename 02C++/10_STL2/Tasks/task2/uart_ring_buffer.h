@@ -0,0 +1,108 @@
+#ifndef UART_RING_BUFFER_H
+#define UART_RING_BUFFER_H
+
+#include <sys/uio.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+// Lock-free single-producer / single-consumer byte ring.
+// The producer fills it straight from a fd with readv into the two free halves,
+// the consumer looks at the stored bytes in place and releases them with consume(n).
+class UARTRingBuffer {
+public:
+    // capacity is rounded up to a power of two
+    explicit UARTRingBuffer(size_t capacity = 64 * 1024)
+        : capacity_(roundUp(capacity)), mask_(capacity_ - 1),
+          data_(new char[capacity_]), head_(0), tail_(0) {}
+
+    UARTRingBuffer(const UARTRingBuffer&) = delete;
+    UARTRingBuffer& operator=(const UARTRingBuffer&) = delete;
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() == capacity_; }
+
+    // ---- Producer side ----
+
+    // Read as much as fits from fd. Returns bytes read, 0 if the ring is full
+    // or the fd had nothing, -1 on error (errno is set).
+    ssize_t readFrom(int fd) {
+        std::string_view filled[2];
+        return readFrom(fd, filled);
+    }
+
+    // Same, and also reports where the new bytes landed (the second view is
+    // empty unless the read wrapped around the end of the ring)
+    ssize_t readFrom(int fd, std::string_view filled[2]) {
+        filled[0] = filled[1] = std::string_view();
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t space = capacity_ - (head - tail);
+        if (space == 0) return 0;
+
+        size_t start = head & mask_;
+        size_t first = capacity_ - start < space ? capacity_ - start : space;
+        iovec iov[2] = {{data_.get() + start, first}, {data_.get(), space - first}};
+        ssize_t n = ::readv(fd, iov, space > first ? 2 : 1);
+        if (n > 0) {
+            size_t got = static_cast<size_t>(n);
+            filled[0] = std::string_view(data_.get() + start, got < first ? got : first);
+            filled[1] = std::string_view(data_.get(), got > first ? got - first : 0);
+            head_.store(head + got, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // ---- Consumer side ----
+
+    // Contiguous run of readable bytes starting at the oldest one
+    std::string_view peek() const {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t used = head_.load(std::memory_order_acquire) - tail;
+        size_t start = tail & mask_;
+        size_t first = capacity_ - start < used ? capacity_ - start : used;
+        return std::string_view(data_.get() + start, first);
+    }
+
+    // All readable bytes as up to two views; returns how many views are used
+    size_t peek(std::string_view parts[2]) const {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t used = head_.load(std::memory_order_acquire) - tail;
+        size_t start = tail & mask_;
+        size_t first = capacity_ - start < used ? capacity_ - start : used;
+        parts[0] = std::string_view(data_.get() + start, first);
+        parts[1] = std::string_view(data_.get(), used - first);
+        return used == 0 ? 0 : (used > first ? 2 : 1);
+    }
+
+    // Byte at logical offset i from the oldest readable byte (i < size())
+    char at(size_t i) const {
+        return data_[(tail_.load(std::memory_order_relaxed) + i) & mask_];
+    }
+
+    // Release n bytes previously seen through peek()
+    void consume(size_t n) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t used = head_.load(std::memory_order_acquire) - tail;
+        tail_.store(tail + (n < used ? n : used), std::memory_order_release);
+    }
+
+private:
+    static size_t roundUp(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<char[]> data_;
+    // Monotonic counters; kept on separate cache lines so producer and consumer don't false-share
+    alignas(64) std::atomic<size_t> head_; // Written by the producer
+    alignas(64) std::atomic<size_t> tail_; // Written by the consumer
+};
+
+#endif // UART_RING_BUFFER_H
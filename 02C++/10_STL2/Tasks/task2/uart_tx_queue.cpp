@@ -0,0 +1,77 @@
+#include "uart_tx_queue.h"
+#include <sys/uio.h>
+#include <cerrno>
+
+bool UARTTxQueue::push(const std::string& message, WriteCallback done) {
+    if (!entries_.empty() && pendingBytes_ + message.size() > highWaterMark_) {
+        ++stats_.rejected;
+        return false;
+    }
+    entries_.push_back({message, std::move(done)});
+    pendingBytes_ += message.size();
+    stats_.bytesQueued += message.size();
+    return true;
+}
+
+bool UARTTxQueue::flush(int fd, const WrittenCallback& written) {
+    while (!entries_.empty()) {
+        iovec iov[kMaxBatch];
+        int count = 0;
+        for (auto it = entries_.begin(); it != entries_.end() && count < kMaxBatch; ++it) {
+            size_t skip = (count == 0) ? headOffset_ : 0;
+            iov[count].iov_base = const_cast<char*>(it->data.data()) + skip;
+            iov[count].iov_len = it->data.size() - skip;
+            ++count;
+        }
+
+        ssize_t n = ::writev(fd, iov, count);
+        ++stats_.syscalls;
+        stats_.iovecs += static_cast<uint64_t>(count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            return false;
+        }
+
+        size_t accepted = static_cast<size_t>(n);
+        stats_.bytesWritten += accepted;
+        pendingBytes_ -= accepted;
+
+        // Report what went out before the messages it came from are retired
+        if (written) {
+            size_t left = accepted;
+            for (int i = 0; i < count && left > 0; ++i) {
+                size_t part = left < iov[i].iov_len ? left : iov[i].iov_len;
+                written(std::string_view(static_cast<const char*>(iov[i].iov_base), part));
+                left -= part;
+            }
+        }
+
+        // Retire fully written messages; a partial one keeps its offset for next time
+        while (accepted > 0 || (!entries_.empty() && entries_.front().data.size() == headOffset_)) {
+            Entry& front = entries_.front();
+            size_t left = front.data.size() - headOffset_;
+            if (accepted < left) {
+                headOffset_ += accepted;
+                break;
+            }
+            accepted -= left;
+            headOffset_ = 0;
+            WriteCallback done = std::move(front.done);
+            entries_.pop_front();
+            ++stats_.messagesWritten;
+            if (done) done(true); // May push more messages
+        }
+    }
+    return true;
+}
+
+void UARTTxQueue::failAll() {
+    std::deque<Entry> failed;
+    failed.swap(entries_);
+    headOffset_ = 0;
+    pendingBytes_ = 0;
+    for (auto& entry : failed) {
+        if (entry.done) entry.done(false);
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef UART_TX_QUEUE_H
+#define UART_TX_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Outbound message queue that drains into a fd with writev(), coalescing
+// pending messages into one syscall and picking up after partial writes.
+class UARTTxQueue {
+public:
+    using WriteCallback = std::function<void(bool ok)>;
+    // Sees the bytes of each writev() that the fd accepted, one call per message slice
+    using WrittenCallback = std::function<void(std::string_view data)>;
+
+    struct Stats {
+        uint64_t bytesQueued = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t messagesWritten = 0;
+        uint64_t syscalls = 0; // writev() calls, including ones that returned EAGAIN
+        uint64_t iovecs = 0;   // Messages handed to those calls
+        uint64_t rejected = 0; // push() calls refused by the high-water mark
+
+        // Average number of messages per writev()
+        double averageBatchSize() const {
+            return syscalls ? static_cast<double>(iovecs) / static_cast<double>(syscalls) : 0.0;
+        }
+    };
+
+    explicit UARTTxQueue(size_t highWaterMark = 64 * 1024) : highWaterMark_(highWaterMark) {}
+
+    // Queue a message; refused (returns false) when it would push the pending
+    // bytes past the high-water mark. An empty queue always accepts one message.
+    bool push(const std::string& message, WriteCallback done = nullptr);
+
+    // Write as much as the fd takes. Returns false on a hard error (errno is set);
+    // running out of room (EAGAIN) is not an error, the rest stays queued.
+    bool flush(int fd, const WrittenCallback& written = nullptr);
+
+    // Drop everything still queued, reporting failure to each message
+    void failAll();
+
+    bool empty() const { return entries_.empty(); }
+    size_t pendingBytes() const { return pendingBytes_; }
+    size_t highWaterMark() const { return highWaterMark_; }
+    void setHighWaterMark(size_t bytes) { highWaterMark_ = bytes; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    static const int kMaxBatch = 64; // iovecs per writev(), well under IOV_MAX
+
+    struct Entry {
+        std::string data;
+        WriteCallback done;
+    };
+
+    std::deque<Entry> entries_;
+    size_t headOffset_ = 0; // Bytes of entries_.front() already written
+    size_t pendingBytes_ = 0;
+    size_t highWaterMark_;
+    Stats stats_;
+};
+
+#endif // UART_TX_QUEUE_H